@@ -15,6 +15,7 @@ public class Voxel : ModuleRules
             {
                 "Core",
                 "Engine",
+                "NetCore",
                 "RealtimeMeshComponent",
 			}
 			);
@@ -25,6 +26,7 @@ public class Voxel : ModuleRules
 			{
 				"CoreUObject",
 				"Engine",
+				"NavigationSystem",
 				"Slate",
 				"SlateCore",
 			}
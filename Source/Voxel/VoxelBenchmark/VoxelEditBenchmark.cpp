@@ -0,0 +1,197 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "VoxelEditBenchmark.h"
+
+#include "Engine/NetConnection.h"
+#include "Engine/NetDriver.h"
+#include "Kismet/GameplayStatics.h"
+#include "Kismet/KismetSystemLibrary.h"
+#include "Misc/FileHelper.h"
+#include "Misc/Paths.h"
+
+#include "VoxelVolume.h"
+
+AVoxelEditBenchmark::AVoxelEditBenchmark()
+{
+	PrimaryActorTick.bCanEverTick = true;
+	PrimaryActorTick.bStartWithTickEnabled = true;
+
+	// Every machine measures its own side, nothing of the benchmark itself is replicated
+	bReplicates = false;
+}
+
+void AVoxelEditBenchmark::BeginPlay()
+{
+	Super::BeginPlay();
+
+	if (!Volume)
+	{
+		Volume = Cast<AVoxelVolume>(UGameplayStatics::GetActorOfClass(this, AVoxelVolume::StaticClass()));
+	}
+
+	if (!Volume)
+	{
+		UE_LOG(LogTemp, Warning, TEXT("[AVoxelEditBenchmark::BeginPlay] No volume to edit"));
+		SetActorTickEnabled(false);
+		return;
+	}
+
+	const UNetDriver* netDriver = GetWorld()->GetNetDriver();
+
+	if (!HasAuthority())
+	{
+		// Clients only count what they receive
+		if (netDriver && netDriver->ServerConnection)
+		{
+			StartInBytes = netDriver->ServerConnection->InTotalBytes;
+		}
+
+		SetActorTickEnabled(false);
+		return;
+	}
+
+	if (bRecordEdits)
+	{
+		Volume->SetEditRecording(&NewEdits);
+		return;
+	}
+
+	TArray<FString> lines;
+	if (!FFileHelper::LoadFileToStringArray(lines, *FPaths::Combine(FPaths::ProjectSavedDir(), RecordedEditsFile)))
+	{
+		UE_LOG(LogTemp, Warning, TEXT("[AVoxelEditBenchmark::BeginPlay] Couldn't read edits %s"), *RecordedEditsFile);
+	}
+
+	for (const FString& line : lines)
+	{
+		TArray<FString> fields;
+		if (line.ParseIntoArrayWS(fields) != 7) continue;
+
+		FRecordedEdit& edit = RecordedEdits.AddDefaulted_GetRef();
+		edit.Seconds = FCString::Atof(*fields[0]);
+		edit.Shape = (EVoxelEditShape)FMath::Clamp(FCString::Atoi(*fields[1]), 0, (int)VES_Cube);
+		edit.Operation = (EVoxelEditOperation)FMath::Clamp(FCString::Atoi(*fields[2]), 0, (int)VEO_Subtract);
+		edit.WorldLocation = FVector(FCString::Atod(*fields[3]), FCString::Atod(*fields[4]), FCString::Atod(*fields[5]));
+		edit.Radius = FCString::Atof(*fields[6]);
+	}
+
+	if (netDriver)
+	{
+		for (UNetConnection* connection : netDriver->ClientConnections)
+		{
+			if (connection) StartOutBytes.Add(connection, connection->OutTotalBytes);
+		}
+	}
+}
+
+void AVoxelEditBenchmark::EndPlay(const EEndPlayReason::Type EndPlayReason)
+{
+	if (Volume && !HasAuthority())
+	{
+		const UNetDriver* netDriver = GetWorld()->GetNetDriver();
+		const int64 receivedBytes = netDriver && netDriver->ServerConnection ? netDriver->ServerConnection->InTotalBytes - StartInBytes : 0;
+
+		UE_LOG(LogTemp, Display, TEXT("[AVoxelEditBenchmark] Client received %.1f KB, holds %d edits and %d snapshots"), receivedBytes / 1024.0, Volume->GetNumEditOps(), Volume->GetNumEditSnapshots());
+	}
+	else if (Volume && bRecordEdits)
+	{
+		RecordNewEdits();
+		Volume->SetEditRecording(nullptr);
+
+		TArray<FString> lines;
+		for (const FRecordedEdit& edit : RecordedEdits)
+		{
+			lines.Add(FString::Printf(TEXT("%.3f %d %d %.1f %.1f %.1f %.1f"), edit.Seconds, (int)edit.Shape, (int)edit.Operation,
+				edit.WorldLocation.X, edit.WorldLocation.Y, edit.WorldLocation.Z, edit.Radius));
+		}
+
+		FFileHelper::SaveStringArrayToFile(lines, *FPaths::Combine(FPaths::ProjectSavedDir(), RecordedEditsFile));
+	}
+	else if (Volume && !bFinished && NextEdit > 0)
+	{
+		// Cut short, still worth a look
+		WriteReport();
+	}
+
+	Super::EndPlay(EndPlayReason);
+}
+
+void AVoxelEditBenchmark::Tick(float DeltaSeconds)
+{
+	Super::Tick(DeltaSeconds);
+
+	if (bFinished) return;
+
+	ElapsedSeconds += DeltaSeconds;
+
+	if (bRecordEdits)
+	{
+		RecordNewEdits();
+		return;
+	}
+
+	for (; NextEdit < RecordedEdits.Num() && RecordedEdits[NextEdit].Seconds <= ElapsedSeconds; NextEdit++)
+	{
+		const FRecordedEdit& edit = RecordedEdits[NextEdit];
+		Volume->ApplyEdit(edit.Shape, edit.Operation, edit.WorldLocation, edit.Radius);
+	}
+
+	const float endSeconds = RecordedEdits.IsEmpty() ? 0.f : RecordedEdits.Last().Seconds;
+	if (NextEdit == RecordedEdits.Num() && ElapsedSeconds > endSeconds + SettleSeconds)
+	{
+		Finish();
+	}
+}
+
+void AVoxelEditBenchmark::RecordNewEdits()
+{
+	// Edits since the last tick, whoever made them
+	for (const FVoxelEditOp& op : NewEdits)
+	{
+		FRecordedEdit& edit = RecordedEdits.AddDefaulted_GetRef();
+		edit.Seconds = ElapsedSeconds;
+		edit.Shape = op.Shape;
+		edit.Operation = op.Operation;
+		edit.WorldLocation = Volume->GetActorTransform().TransformPosition(op.Location);
+		edit.Radius = op.Radius;
+	}
+
+	NextEdit += NewEdits.Num();
+	NewEdits.Reset();
+}
+
+void AVoxelEditBenchmark::Finish()
+{
+	bFinished = true;
+	WriteReport();
+
+	if (bQuitWhenDone)
+	{
+		UKismetSystemLibrary::QuitGame(this, nullptr, EQuitPreference::Quit, false);
+	}
+}
+
+void AVoxelEditBenchmark::WriteReport() const
+{
+	UE_LOG(LogTemp, Display, TEXT("[AVoxelEditBenchmark] %d edits replayed over %.1f s, %d left as ops and %d snapshots in the volume"), NextEdit, ElapsedSeconds, Volume->GetNumEditOps(), Volume->GetNumEditSnapshots());
+
+	const UNetDriver* netDriver = GetWorld()->GetNetDriver();
+	if (!netDriver || netDriver->ClientConnections.IsEmpty())
+	{
+		UE_LOG(LogTemp, Display, TEXT("  No clients connected"));
+		return;
+	}
+
+	for (UNetConnection* connection : netDriver->ClientConnections)
+	{
+		if (!connection) continue;
+
+		// Clients joining during the replay are counted from their first byte, and include the log sent as their initial state
+		const int64* startBytes = StartOutBytes.Find(connection);
+		const int64 sentBytes = connection->OutTotalBytes - (startBytes ? *startBytes : 0);
+
+		UE_LOG(LogTemp, Display, TEXT("  %s: %.1f KB sent, %.1f bytes per edit, %.2f KB/s"), *connection->LowLevelGetRemoteAddress(true),
+			sentBytes / 1024.0, NextEdit ? (double)sentBytes / NextEdit : 0.0, ElapsedSeconds > 0.f ? sentBytes / 1024.0 / ElapsedSeconds : 0.0);
+	}
+}
@@ -0,0 +1,79 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "GameFramework/Actor.h"
+
+#include "VoxelEdit/VoxelEditOp.h"
+
+#include "VoxelEditBenchmark.generated.h"
+
+class AVoxelVolume;
+class UNetConnection;
+
+// Replays a recorded dig session on the server and reports the bytes each client was sent while it ran.
+// Meant for a loopback session, e.g. play in editor as a listen server with two clients. Clients log what they
+// received and how many edits they applied when they end play, so the replicated logs can be compared
+UCLASS()
+class VOXEL_API AVoxelEditBenchmark : public AActor
+{
+	GENERATED_BODY()
+
+public:
+
+	AVoxelEditBenchmark();
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Voxel|Benchmark")
+	TObjectPtr<AVoxelVolume> Volume;
+
+	// Recorded session relative to the project's saved directory, one edit per line:
+	// seconds, shape, operation, world location x y z, radius
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Voxel|Benchmark")
+	FString RecordedEditsFile;
+
+	// Records the edits players make on the server into RecordedEditsFile instead of replaying anything
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Voxel|Benchmark")
+	bool bRecordEdits = false;
+
+	// Waited after the last edit, so its replication is counted
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Voxel|Benchmark", Meta = (ClampMin = "0"))
+	float SettleSeconds = 3.f;
+
+	// Exits once the session is replayed and the report written
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Voxel|Benchmark")
+	bool bQuitWhenDone = true;
+
+protected:
+
+	struct FRecordedEdit
+	{
+		float Seconds = 0.f;
+		EVoxelEditShape Shape = VES_Sphere;
+		EVoxelEditOperation Operation = VEO_Subtract;
+		FVector WorldLocation = FVector::ZeroVector;
+		float Radius = 0.f;
+	};
+
+	virtual void BeginPlay() override;
+	virtual void EndPlay(const EEndPlayReason::Type EndPlayReason) override;
+	virtual void Tick(float DeltaSeconds) override;
+
+	void RecordNewEdits();
+	void Finish();
+	void WriteReport() const;
+
+	TArray<FRecordedEdit> RecordedEdits;
+	int32 NextEdit = 0;
+
+	// Recording, edits the volume got since the last tick
+	TArray<FVoxelEditOp> NewEdits;
+	float ElapsedSeconds = 0.f;
+	bool bFinished = false;
+
+	// Server side, bytes sent to each client connection when the replay started
+	TMap<TWeakObjectPtr<UNetConnection>, int64> StartOutBytes;
+
+	// Client side, bytes received from the server when play started
+	int64 StartInBytes = 0;
+};
@@ -0,0 +1,242 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "VoxelStreamingBenchmark.h"
+
+#include "Components/SplineComponent.h"
+#include "GameFramework/Pawn.h"
+#include "GameFramework/PlayerController.h"
+#include "Kismet/GameplayStatics.h"
+#include "Kismet/KismetSystemLibrary.h"
+#include "Misc/FileHelper.h"
+#include "Misc/Paths.h"
+
+#include "VoxelVolume.h"
+
+namespace
+{
+	// Upper bounds of the latency histogram buckets, in frames at 60 fps doubling each bucket
+	constexpr double LatencyBucketsMs[] = { 16.7, 33.3, 66.7, 133.3, 266.7, 533.3, 1066.7, 2133.3, 4266.7 };
+
+	double GetPercentile(const TArray<double>& InSorted, double InPercentile)
+	{
+		if (InSorted.IsEmpty()) return 0.0;
+		return InSorted[FMath::Clamp(FMath::FloorToInt(InSorted.Num() * InPercentile), 0, InSorted.Num() - 1)];
+	}
+}
+
+AVoxelStreamingBenchmark::AVoxelStreamingBenchmark()
+{
+	PrimaryActorTick.bCanEverTick = true;
+	PrimaryActorTick.bStartWithTickEnabled = true;
+
+	// Samples what the volumes did this frame
+	PrimaryActorTick.TickGroup = TG_PostUpdateWork;
+
+	Path = CreateDefaultSubobject<USplineComponent>(TEXT("Path"));
+	RootComponent = Path;
+}
+
+void AVoxelStreamingBenchmark::BeginPlay()
+{
+	Super::BeginPlay();
+
+	if (!Volume)
+	{
+		Volume = Cast<AVoxelVolume>(UGameplayStatics::GetActorOfClass(this, AVoxelVolume::StaticClass()));
+	}
+
+	if (!Volume)
+	{
+		UE_LOG(LogTemp, Warning, TEXT("[AVoxelStreamingBenchmark::BeginPlay] No volume to measure"));
+		SetActorTickEnabled(false);
+		return;
+	}
+
+	if (!bRecordPath && !RecordedPathFile.IsEmpty())
+	{
+		TArray<FString> lines;
+		if (!FFileHelper::LoadFileToStringArray(lines, *FPaths::Combine(FPaths::ProjectSavedDir(), RecordedPathFile)))
+		{
+			UE_LOG(LogTemp, Warning, TEXT("[AVoxelStreamingBenchmark::BeginPlay] Couldn't read path %s"), *RecordedPathFile);
+		}
+
+		for (const FString& line : lines)
+		{
+			FVector point;
+			if (point.InitFromString(line)) RecordedPoints.Add(point);
+		}
+	}
+
+	Volume->SetStreamingStats(&Stats);
+	LastTickSeconds = FPlatformTime::Seconds();
+}
+
+void AVoxelStreamingBenchmark::EndPlay(const EEndPlayReason::Type EndPlayReason)
+{
+	if (Volume)
+	{
+		Volume->SetStreamingStats(nullptr);
+	}
+
+	if (bRecordPath)
+	{
+		TArray<FString> lines;
+		for (const FVector& point : RecordedPoints)
+		{
+			lines.Add(point.ToString());
+		}
+
+		FFileHelper::SaveStringArrayToFile(lines, *FPaths::Combine(FPaths::ProjectSavedDir(), RecordedPathFile));
+	}
+	else if (!bFinished && Frames.Num())
+	{
+		// Cut short, still worth a look
+		WriteReport();
+	}
+
+	Super::EndPlay(EndPlayReason);
+}
+
+void AVoxelStreamingBenchmark::Tick(float DeltaSeconds)
+{
+	Super::Tick(DeltaSeconds);
+
+	if (bFinished) return;
+
+	APawn* pawn = GetPlayerPawn();
+	if (!pawn) return;
+
+	ElapsedSeconds += DeltaSeconds;
+
+	if (bRecordPath)
+	{
+		if (RecordedPathFile.IsEmpty()) return;
+
+		while (NextRecordSeconds <= ElapsedSeconds)
+		{
+			RecordedPoints.Add(pawn->GetActorLocation());
+			NextRecordSeconds += RecordInterval;
+		}
+		return;
+	}
+
+	// What the volume did since the last tick, with the pawn where it was moved to then
+	const double nowSeconds = FPlatformTime::Seconds();
+
+	FFrameSample& frame = Frames.AddDefaulted_GetRef();
+	frame.FrameMs = (nowSeconds - LastTickSeconds) * 1000.0;
+	frame.UpdateVolumeMs = Stats.UpdateVolumeSeconds * 1000.0;
+	frame.GenerationsInFlight = Volume->GetNumGenerationsInFlight();
+	frame.MemoryBytes = Volume->GetChunkMemoryTotalBytes();
+	frame.bAtMaxDepth = Volume->IsAtMaxDepth(pawn->GetActorLocation());
+
+	ReadyLatencies.Append(Stats.ReadyLatencies);
+	Stats.Reset();
+	LastTickSeconds = nowSeconds;
+
+	FVector location;
+	FRotator rotation;
+	if (!GetPathTransform(location, rotation))
+	{
+		Finish();
+		return;
+	}
+
+	pawn->SetActorLocationAndRotation(location, rotation);
+	if (AController* controller = pawn->GetController())
+	{
+		controller->SetControlRotation(rotation);
+	}
+}
+
+APawn* AVoxelStreamingBenchmark::GetPlayerPawn() const
+{
+	const APlayerController* PC = GetWorld()->GetFirstPlayerController();
+	return PC ? PC->GetPawn() : nullptr;
+}
+
+bool AVoxelStreamingBenchmark::GetPathTransform(FVector& OutLocation, FRotator& OutRotation) const
+{
+	if (RecordedPoints.Num())
+	{
+		const float position = ElapsedSeconds / RecordInterval;
+		const int index = FMath::FloorToInt(position);
+		if (index + 1 >= RecordedPoints.Num()) return false;
+
+		const FVector& from = RecordedPoints[index];
+		const FVector& to = RecordedPoints[index + 1];
+		OutLocation = FMath::Lerp(from, to, position - index);
+		OutRotation = (to - from).Rotation();
+		return true;
+	}
+
+	const float distance = ElapsedSeconds * Speed;
+	if (distance > Path->GetSplineLength()) return false;
+
+	OutLocation = Path->GetLocationAtDistanceAlongSpline(distance, ESplineCoordinateSpace::World);
+	OutRotation = Path->GetRotationAtDistanceAlongSpline(distance, ESplineCoordinateSpace::World);
+	return true;
+}
+
+void AVoxelStreamingBenchmark::Finish()
+{
+	bFinished = true;
+	WriteReport();
+
+	if (bQuitWhenDone)
+	{
+		UKismetSystemLibrary::QuitGame(this, nullptr, EQuitPreference::Quit, false);
+	}
+}
+
+void AVoxelStreamingBenchmark::WriteReport() const
+{
+	TArray<double> updateMs;
+	int peakInFlight = 0;
+	int64 peakMemoryBytes = 0;
+	int framesBelowMaxDepth = 0;
+
+	FString csv = TEXT("Frame,FrameMs,UpdateVolumeMs,GenerationsInFlight,MemoryMB,AtMaxDepth\n");
+	for (int i = 0; i < Frames.Num(); i++)
+	{
+		const FFrameSample& frame = Frames[i];
+		updateMs.Add(frame.UpdateVolumeMs);
+		peakInFlight = FMath::Max(peakInFlight, frame.GenerationsInFlight);
+		peakMemoryBytes = FMath::Max(peakMemoryBytes, frame.MemoryBytes);
+		framesBelowMaxDepth += !frame.bAtMaxDepth;
+
+		csv += FString::Printf(TEXT("%d,%.3f,%.3f,%d,%.2f,%d\n"),
+			i, frame.FrameMs, frame.UpdateVolumeMs, frame.GenerationsInFlight, frame.MemoryBytes / (1024.0 * 1024.0), frame.bAtMaxDepth ? 1 : 0);
+	}
+
+	const FString csvPath = FPaths::Combine(FPaths::ProfilingDir(), FString::Printf(TEXT("VoxelStreaming-%s.csv"), *FDateTime::Now().ToString()));
+	FFileHelper::SaveStringToFile(csv, *csvPath);
+
+	updateMs.Sort();
+	TArray<double> latencies = ReadyLatencies;
+	latencies.Sort();
+
+	UE_LOG(LogTemp, Display, TEXT("[AVoxelStreamingBenchmark] %d frames, per frame csv in %s"), Frames.Num(), *csvPath);
+	UE_LOG(LogTemp, Display, TEXT("  UpdateVolume ms: p50 %.3f, p95 %.3f, max %.3f"),
+		GetPercentile(updateMs, 0.5), GetPercentile(updateMs, 0.95), updateMs.IsEmpty() ? 0.0 : updateMs.Last());
+	UE_LOG(LogTemp, Display, TEXT("  Request to ready ms (%d chunks): p50 %.1f, p95 %.1f, max %.1f"), latencies.Num(),
+		GetPercentile(latencies, 0.5) * 1000.0, GetPercentile(latencies, 0.95) * 1000.0, latencies.IsEmpty() ? 0.0 : latencies.Last() * 1000.0);
+
+	int idxLatency = 0;
+	double lowerBoundMs = 0.0;
+	for (const double upperBoundMs : LatencyBucketsMs)
+	{
+		int count = 0;
+		for (; idxLatency < latencies.Num() && latencies[idxLatency] * 1000.0 < upperBoundMs; idxLatency++) count++;
+
+		UE_LOG(LogTemp, Display, TEXT("    %7.1f - %7.1f: %d"), lowerBoundMs, upperBoundMs, count);
+		lowerBoundMs = upperBoundMs;
+	}
+	UE_LOG(LogTemp, Display, TEXT("    %7.1f +        : %d"), lowerBoundMs, latencies.Num() - idxLatency);
+
+	UE_LOG(LogTemp, Display, TEXT("  Peak generations in flight: %d"), peakInFlight);
+	UE_LOG(LogTemp, Display, TEXT("  Peak chunk memory: %.2f MB"), peakMemoryBytes / (1024.0 * 1024.0));
+	UE_LOG(LogTemp, Display, TEXT("  Frames with the player's chunk below max depth: %d (%.1f%%)"),
+		framesBelowMaxDepth, Frames.Num() ? 100.0 * framesBelowMaxDepth / Frames.Num() : 0.0);
+}
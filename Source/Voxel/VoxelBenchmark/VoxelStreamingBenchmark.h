@@ -0,0 +1,82 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "GameFramework/Actor.h"
+
+#include "VoxelBenchmark/VoxelStreamingStats.h"
+
+#include "VoxelStreamingBenchmark.generated.h"
+
+class AVoxelVolume;
+class USplineComponent;
+
+// Moves the first player's pawn along a scripted or recorded path through a volume and reports how streaming kept up.
+// Meant to run headless so builds can be compared, e.g. "-game -nullrhi -benchmark -fps=30 -unattended"
+UCLASS()
+class VOXEL_API AVoxelStreamingBenchmark : public AActor
+{
+	GENERATED_BODY()
+
+public:
+
+	AVoxelStreamingBenchmark();
+
+	// Scripted path, used when there's no recorded one
+	UPROPERTY(VisibleAnywhere, BlueprintReadOnly)
+	TObjectPtr<USplineComponent> Path;
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Voxel|Benchmark")
+	TObjectPtr<AVoxelVolume> Volume;
+
+	// Units per second along the scripted path
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Voxel|Benchmark", Meta = (ClampMin = "1"))
+	float Speed = 2000.f;
+
+	// Recorded path relative to the project's saved directory, one world location per line every RecordInterval
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Voxel|Benchmark")
+	FString RecordedPathFile;
+
+	// Records the player's own flight into RecordedPathFile instead of replaying anything
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Voxel|Benchmark")
+	bool bRecordPath = false;
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Voxel|Benchmark", Meta = (ClampMin = "0.01"))
+	float RecordInterval = 0.1f;
+
+	// Exits once the path is done and the report written
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Voxel|Benchmark")
+	bool bQuitWhenDone = true;
+
+protected:
+
+	struct FFrameSample
+	{
+		float FrameMs = 0.f;
+		float UpdateVolumeMs = 0.f;
+		int32 GenerationsInFlight = 0;
+		int64 MemoryBytes = 0;
+		bool bAtMaxDepth = false;
+	};
+
+	virtual void BeginPlay() override;
+	virtual void EndPlay(const EEndPlayReason::Type EndPlayReason) override;
+	virtual void Tick(float DeltaSeconds) override;
+
+	APawn* GetPlayerPawn() const;
+	bool GetPathTransform(FVector& OutLocation, FRotator& OutRotation) const;
+	void Finish();
+	void WriteReport() const;
+
+	FVoxelStreamingStats Stats;
+
+	TArray<FFrameSample> Frames;
+	TArray<double> ReadyLatencies;
+
+	TArray<FVector> RecordedPoints;
+	double LastTickSeconds = 0.0;
+	float ElapsedSeconds = 0.f;
+	float NextRecordSeconds = 0.f;
+	bool bFinished = false;
+};
@@ -0,0 +1,21 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+// Filled by a volume while it's set, read and reset by whoever measures it (once per frame)
+struct FVoxelStreamingStats
+{
+	// Game thread time spent in asynchronous volume updates
+	double UpdateVolumeSeconds = 0.0;
+
+	// Seconds from a chunk's generation request to its section update, for the chunks uploaded
+	TArray<double> ReadyLatencies;
+
+	void Reset()
+	{
+		UpdateVolumeSeconds = 0.0;
+		ReadyLatencies.Reset();
+	}
+};
@@ -1,9 +1,8 @@
 // Fill out your copyright notice in the Description page of Project Settings.
 
 #include "AsyncVoxelGenerateChunk.h"
-#include "VoxelVolume.h"
 
 void AsyncVoxelGenerateChunk::DoWork()
 {
-	VoxelVolume->RegenerateChunk(DirtyChunkData);
-}
\ No newline at end of file
+	Pipeline->RunWorker(Stage);
+}
@@ -4,19 +4,21 @@
 
 #include "CoreMinimal.h"
 
+#include "VoxelChunk/VoxelGenerationPipeline.h"
+
+// One worker of a generation pipeline stage, see FVoxelGenerationPipeline::RunWorker
 class AsyncVoxelGenerateChunk : FNonAbandonableTask
 {
-	friend class FAsyncTask<AsyncVoxelGenerateChunk>;
+	friend class FAutoDeleteAsyncTask<AsyncVoxelGenerateChunk>;
 
-	AVoxelVolume* VoxelVolume = nullptr;
-	FVoxelDirtyChunkData* DirtyChunkData = nullptr;
+	FVoxelGenerationPipeline* Pipeline = nullptr;
+	EVoxelGenerationStage Stage = EVoxelGenerationStage::Density;
 
-	AsyncVoxelGenerateChunk(AVoxelVolume* InVoxelVolume, FVoxelDirtyChunkData* InDirtyChunkData) :
-		VoxelVolume(InVoxelVolume),
-		DirtyChunkData(InDirtyChunkData)
+	AsyncVoxelGenerateChunk(FVoxelGenerationPipeline* InPipeline, EVoxelGenerationStage InStage) :
+		Pipeline(InPipeline),
+		Stage(InStage)
 	{
-		check(VoxelVolume);
-		check(DirtyChunkData);
+		check(Pipeline);
 	}
 
 	void DoWork();
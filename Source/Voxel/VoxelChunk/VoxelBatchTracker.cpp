@@ -0,0 +1,107 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "VoxelBatchTracker.h"
+
+#include "VoxelDirtyChunkData.h"
+
+void FVoxelBatchTracker::Track(FVoxelDirtyChunkData* InChunkData)
+{
+	// Started again (refined, or restarted with new settings), its previous generation no longer counts
+	Untrack(InChunkData);
+
+	// 0 stands for untracked
+	if (++NextGenerationId == 0) ++NextGenerationId;
+
+	InChunkData->GenerationId = NextGenerationId;
+	PendingGenerations.Add(InChunkData->GenerationId, InChunkData);
+
+	if (InChunkData->BatchChunkKey)
+	{
+		PendingCounts.FindOrAdd(InChunkData->BatchChunkKey)++;
+	}
+}
+
+void FVoxelBatchTracker::Untrack(FVoxelDirtyChunkData* InChunkData)
+{
+	if (InChunkData->GenerationId && PendingGenerations.Remove(InChunkData->GenerationId))
+	{
+		Finish(InChunkData);
+	}
+
+	InChunkData->GenerationId = 0;
+}
+
+void FVoxelBatchTracker::SetBatch(FVoxelDirtyChunkData* InChunkData, FVoxelChunkNode* InBatchChunkKey)
+{
+	const bool bIsPending = InChunkData->GenerationId && PendingGenerations.Contains(InChunkData->GenerationId);
+
+	if (bIsPending && InChunkData->BatchChunkKey)
+	{
+		int32& count = PendingCounts.FindChecked(InChunkData->BatchChunkKey);
+		if (--count == 0)
+		{
+			PendingCounts.Remove(InChunkData->BatchChunkKey);
+			BatchesToCheck.Add(InChunkData->BatchChunkKey);
+		}
+	}
+
+	InChunkData->BatchChunkKey = InBatchChunkKey;
+
+	if (bIsPending && InBatchChunkKey)
+	{
+		PendingCounts.FindOrAdd(InBatchChunkKey)++;
+	}
+}
+
+void FVoxelBatchTracker::Complete(const FVoxelDirtyChunkData* InChunkData)
+{
+	CompletedIds.Enqueue(InChunkData->GenerationId);
+}
+
+void FVoxelBatchTracker::Drain()
+{
+	uint32 generationId;
+	while (CompletedIds.Dequeue(generationId))
+	{
+		FVoxelDirtyChunkData* chunkData = nullptr;
+		if (PendingGenerations.RemoveAndCopyValue(generationId, chunkData))
+		{
+			chunkData->GenerationId = 0;
+			Finish(chunkData);
+		}
+	}
+}
+
+void FVoxelBatchTracker::Finish(FVoxelDirtyChunkData* InChunkData)
+{
+	if (FVoxelChunkNode* batchChunkKey = InChunkData->BatchChunkKey)
+	{
+		int32& count = PendingCounts.FindChecked(batchChunkKey);
+		if (--count == 0)
+		{
+			PendingCounts.Remove(batchChunkKey);
+			BatchesToCheck.Add(batchChunkKey);
+		}
+	}
+
+	FVoxelChunkNode* waiter = nullptr;
+	if (Waiters.RemoveAndCopyValue(InChunkData->Chunk, waiter))
+	{
+		BatchesToCheck.Add(waiter);
+	}
+}
+
+void FVoxelBatchTracker::ForgetNode(FVoxelChunkNode* InNode)
+{
+	Waiters.Remove(InNode);
+	BatchesToCheck.Remove(InNode);
+}
+
+void FVoxelBatchTracker::Reset()
+{
+	// Their chunk data are released by now, ids still in the queue aren't pending anymore
+	PendingGenerations.Empty();
+	PendingCounts.Empty();
+	BatchesToCheck.Empty();
+	Waiters.Empty();
+}
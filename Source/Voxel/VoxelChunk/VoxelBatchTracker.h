@@ -0,0 +1,58 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Containers/Queue.h"
+
+struct FVoxelChunkNode;
+struct FVoxelDirtyChunkData;
+
+// Which dirty chunk batches are worth looking at. Workers push finished generations onto a lock free queue, the game
+// thread drains it and counts down what each batch still waits on, so only batches whose state changed are checked
+struct FVoxelBatchTracker
+{
+	// Game thread, InChunkData counts against its batch until it completes or is released
+	void Track(FVoxelDirtyChunkData* InChunkData);
+	void Untrack(FVoxelDirtyChunkData* InChunkData);
+
+	// Game thread, a pending generation moves to InBatchChunkKey (prefetched chunks adopted by a batch)
+	void SetBatch(FVoxelDirtyChunkData* InChunkData, FVoxelChunkNode* InBatchChunkKey);
+
+	// Any thread, the last stage of InChunkData finished
+	void Complete(const FVoxelDirtyChunkData* InChunkData);
+
+	// Game thread, untracks the generations completed since the last drain
+	void Drain();
+
+	// Generations tracked against the batch that haven't completed
+	bool IsPending(const FVoxelChunkNode* InBatchChunkKey) const { return PendingCounts.Contains(InBatchChunkKey); };
+
+	// The batch is checked again once InNode's generation is done, for generations of replaced nodes that aren't its own
+	void WaitOn(FVoxelChunkNode* InNode, FVoxelChunkNode* InBatchChunkKey) { Waiters.Add(InNode, InBatchChunkKey); };
+
+	void MarkForCheck(FVoxelChunkNode* InBatchChunkKey) { BatchesToCheck.Add(InBatchChunkKey); };
+	void MarkChecked(FVoxelChunkNode* InBatchChunkKey) { BatchesToCheck.Remove(InBatchChunkKey); };
+	void GetBatchesToCheck(TArray<FVoxelChunkNode*>& OutBatchChunkKeys) const { OutBatchChunkKeys = BatchesToCheck.Array(); };
+
+	// InNode is deleted, nothing should wait on it anymore
+	void ForgetNode(FVoxelChunkNode* InNode);
+
+	void Reset();
+
+protected:
+
+	void Finish(FVoxelDirtyChunkData* InChunkData);
+
+	// Ids of completed generations, a released chunk data's id is no longer pending and its completion is ignored
+	TQueue<uint32, EQueueMode::Mpsc> CompletedIds;
+
+	TMap<uint32, FVoxelDirtyChunkData*> PendingGenerations;
+	uint32 NextGenerationId = 0;
+
+	// Per batch key, tracked generations not completed yet, removed at 0
+	TMap<FVoxelChunkNode*, int32> PendingCounts;
+
+	TSet<FVoxelChunkNode*> BatchesToCheck;
+	TMap<FVoxelChunkNode*, FVoxelChunkNode*> Waiters;
+};
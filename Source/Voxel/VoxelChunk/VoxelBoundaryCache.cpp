@@ -0,0 +1,131 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "VoxelBoundaryCache.h"
+
+#include "VoxelChunkMemory.h"
+
+bool FVoxelBoundaryCache::Consume(const FFaceKey& InKey, TArray<double>& OutSamples)
+{
+	FScopeLock scopeLock(&Lock);
+
+	FFace face;
+	if (!Faces.RemoveAndCopyValue(InKey, face)) return false;
+
+	if (Memory)
+	{
+		Memory->Add(EVoxelMemoryCategory::Boundaries, -(int64)face.Samples.GetAllocatedSize());
+	}
+
+	OutSamples = MoveTemp(face.Samples);
+	return true;
+}
+
+bool FVoxelBoundaryCache::PublishOrAdopt(const FFaceKey& InKey, TArray<double>& InOutSamples)
+{
+	FScopeLock scopeLock(&Lock);
+
+	if (FFace* face = Faces.Find(InKey))
+	{
+		if (face->Samples.Num() == InOutSamples.Num())
+		{
+			InOutSamples = face->Samples;
+		}
+
+		RemoveFace(InKey);
+		return true;
+	}
+
+	FFace& face = Faces.Add(InKey);
+	face.Samples = InOutSamples;
+	face.Order = ++PublishCounter;
+	PublishOrder.Emplace(InKey, face.Order);
+
+	if (Memory)
+	{
+		Memory->Add(EVoxelMemoryCategory::Boundaries, face.Samples.GetAllocatedSize());
+	}
+
+	// Neighbours that never got generated, usually out of range by now
+	if (Faces.Num() > MaxFaces)
+	{
+		EvictOldest();
+	}
+
+	// Most faces are consumed rather than evicted, their entries are dropped once they outnumber the cached ones
+	if (PublishOrder.Num() - PublishOrderHead > 2 * FMath::Max(MaxFaces, Faces.Num()))
+	{
+		PublishOrder.RemoveAll([this](const TPair<FFaceKey, uint64>& InEntry)
+			{
+				const FFace* cached = Faces.Find(InEntry.Key);
+				return !cached || cached->Order != InEntry.Value;
+			}
+		);
+		PublishOrderHead = 0;
+	}
+
+	return false;
+}
+
+void FVoxelBoundaryCache::EvictOldest()
+{
+	while (PublishOrderHead < PublishOrder.Num())
+	{
+		const TPair<FFaceKey, uint64>& entry = PublishOrder[PublishOrderHead++];
+
+		const FFace* cached = Faces.Find(entry.Key);
+		if (cached && cached->Order == entry.Value)
+		{
+			RemoveFace(entry.Key);
+			break;
+		}
+	}
+
+	// Popped entries are freed in blocks, not one at a time
+	if (PublishOrderHead > MaxFaces)
+	{
+		PublishOrder.RemoveAt(0, PublishOrderHead, false);
+		PublishOrderHead = 0;
+	}
+}
+
+void FVoxelBoundaryCache::Empty()
+{
+	FScopeLock scopeLock(&Lock);
+
+	TArray<FFaceKey> keys;
+	Faces.GetKeys(keys);
+
+	for (const FFaceKey& key : keys)
+	{
+		RemoveFace(key);
+	}
+
+	PublishOrder.Empty();
+	PublishOrderHead = 0;
+}
+
+void FVoxelBoundaryCache::RemoveIf(TFunctionRef<bool(const FFaceKey&)> InPredicate)
+{
+	FScopeLock scopeLock(&Lock);
+
+	// Their publish order entries no longer match and are skipped
+	TArray<FFaceKey> keys;
+	for (const TPair<FFaceKey, FFace>& face : Faces)
+	{
+		if (InPredicate(face.Key)) keys.Add(face.Key);
+	}
+
+	for (const FFaceKey& key : keys)
+	{
+		RemoveFace(key);
+	}
+}
+
+void FVoxelBoundaryCache::RemoveFace(const FFaceKey& InKey)
+{
+	FFace face;
+	if (Faces.RemoveAndCopyValue(InKey, face) && Memory)
+	{
+		Memory->Add(EVoxelMemoryCategory::Boundaries, -(int64)face.Samples.GetAllocatedSize());
+	}
+}
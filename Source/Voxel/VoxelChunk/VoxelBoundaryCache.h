@@ -0,0 +1,96 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+#include "VoxelChunk/VoxelChunkNode.h"
+
+struct FVoxelChunkMemory;
+
+// Corner densities on the faces between chunks of the same depth, sampled by whichever chunk gets there first
+// and handed to the neighbour, so both sides of a seam are built from the exact same values. Thread safe
+struct FVoxelBoundaryCache
+{
+	// A face plane between two cells of the same depth, Plane is the cell on the high side of it.
+	// Epoch is the generator's version the samples were taken from, EditSequence the last edit touching the face,
+	// sides sampled from different density fields never share
+	struct FFaceKey
+	{
+		uint8 Depth = 0;
+		uint8 Axis = 0;
+		FIntVector Plane = FIntVector::ZeroValue;
+		uint32 Epoch = 0;
+		uint32 EditSequence = 0;
+
+		bool operator==(const FFaceKey& Other) const
+		{
+			return Depth == Other.Depth && Axis == Other.Axis && Plane == Other.Plane && Epoch == Other.Epoch && EditSequence == Other.EditSequence;
+		}
+
+		friend uint32 GetTypeHash(const FFaceKey& InKey)
+		{
+			const uint32 versionHash = HashCombine(GetTypeHash(InKey.Epoch), GetTypeHash(InKey.EditSequence));
+			return HashCombine(HashCombine(GetTypeHash(InKey.Depth | (InKey.Axis << 8)), GetTypeHash(InKey.Plane)), versionHash);
+		}
+	};
+
+	FVoxelBoundaryCache(FVoxelChunkMemory* InMemory) :
+		Memory(InMemory) {};
+
+	~FVoxelBoundaryCache()
+	{
+		Empty();
+	}
+
+	static FFaceKey MakeFaceKey(const FVoxelChunkKey& InChunkKey, uint8 InAxis, bool bInHighSide, uint32 InEpoch, uint32 InEditSequence)
+	{
+		FFaceKey key;
+		key.Depth = InChunkKey.Depth;
+		key.Axis = InAxis;
+		key.Epoch = InEpoch;
+		key.EditSequence = InEditSequence;
+		key.Plane = InChunkKey.Cell;
+		key.Plane[InAxis] += bInHighSide ? 1 : 0;
+		return key;
+	}
+
+	// Moves the face's samples out when the neighbour published it, both sides have it then so it's dropped
+	bool Consume(const FFaceKey& InKey, TArray<double>& OutSamples);
+
+	// Publishes the samples for the neighbour, unless it published first, InOutSamples then receives its values
+	bool PublishOrAdopt(const FFaceKey& InKey, TArray<double>& InOutSamples);
+
+	void Empty();
+
+	// Drops the faces InPredicate matches, e.g. the ones an edit made stale
+	void RemoveIf(TFunctionRef<bool(const FFaceKey&)> InPredicate);
+
+	const int32 Num() const { return Faces.Num(); };
+
+	// Faces whose neighbour never came, oldest dropped past this
+	int32 MaxFaces = 4096;
+
+protected:
+
+	struct FFace
+	{
+		TArray<double> Samples;
+		uint64 Order = 0;
+	};
+
+	void RemoveFace(const FFaceKey& InKey);
+
+	// Drops the oldest face still in the cache, entries of consumed faces are skipped on the way
+	void EvictOldest();
+
+	FCriticalSection Lock;
+	TMap<FFaceKey, FFace> Faces;
+	uint64 PublishCounter = 0;
+
+	// Published faces in order, from PublishOrderHead. A face is still cached if its key maps to the same Order
+	TArray<TPair<FFaceKey, uint64>> PublishOrder;
+	int32 PublishOrderHead = 0;
+
+	FVoxelChunkMemory* Memory = nullptr;
+};
@@ -0,0 +1,56 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "VoxelChunkMemory.h"
+
+#include "VoxelChunk/VoxelDirtyChunkData.h"
+
+void FVoxelChunkMemory::Retain(FVoxelChunkNode* InNode, FVoxelDirtyChunkData* InChunkData)
+{
+	check(!RetainedChunkData.Contains(InNode));
+
+	FRetainedChunkData& retained = RetainedChunkData.Add(InNode);
+	retained.ChunkData = InChunkData;
+	retained.LastUsed = ++UseCounter;
+
+	RetainedBytes += InChunkData->DensityBytes + InChunkData->StreamBytes;
+}
+
+FVoxelDirtyChunkData* FVoxelChunkMemory::FindRetained(FVoxelChunkNode* InNode)
+{
+	if (FRetainedChunkData* retained = RetainedChunkData.Find(InNode))
+	{
+		retained->LastUsed = ++UseCounter;
+		return retained->ChunkData;
+	}
+
+	return nullptr;
+}
+
+FVoxelDirtyChunkData* FVoxelChunkMemory::RemoveRetained(FVoxelChunkNode* InNode)
+{
+	FRetainedChunkData retained;
+	if (RetainedChunkData.RemoveAndCopyValue(InNode, retained))
+	{
+		RetainedBytes -= retained.ChunkData->DensityBytes + retained.ChunkData->StreamBytes;
+		return retained.ChunkData;
+	}
+
+	return nullptr;
+}
+
+FVoxelDirtyChunkData* FVoxelChunkMemory::EvictLeastRecentlyUsed()
+{
+	FVoxelChunkNode* oldestNode = nullptr;
+	uint64 oldestUse = MAX_uint64;
+
+	for (const TPair<FVoxelChunkNode*, FRetainedChunkData>& retained : RetainedChunkData)
+	{
+		if (retained.Value.LastUsed < oldestUse)
+		{
+			oldestUse = retained.Value.LastUsed;
+			oldestNode = retained.Key;
+		}
+	}
+
+	return oldestNode ? RemoveRetained(oldestNode) : nullptr;
+}
@@ -0,0 +1,81 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "HAL/ThreadSafeCounter64.h"
+
+#include "VoxelChunkMemory.generated.h"
+
+struct FVoxelChunkNode;
+struct FVoxelDirtyChunkData;
+
+UENUM(BlueprintType)
+enum class EVoxelMemoryCategory : uint8
+{
+	// Corner density grids
+	Density,
+	// Mesh streams waiting for upload
+	Streams,
+	// Octree nodes
+	Nodes,
+	// Chunk face samples waiting for their neighbour
+	Boundaries,
+
+	MAX UMETA(Hidden)
+};
+
+// Bytes held by a volume per category, and the chunk data it keeps after upload (evicted least recently used first)
+struct FVoxelChunkMemory
+{
+	void Add(EVoxelMemoryCategory InCategory, int64 InBytes)
+	{
+		Bytes[(uint8)InCategory].Add(InBytes);
+	}
+
+	const int64 Get(EVoxelMemoryCategory InCategory) const
+	{
+		return Bytes[(uint8)InCategory].GetValue();
+	}
+
+	const int64 GetTotal() const
+	{
+		int64 total = 0;
+		for (uint8 i = 0; i < (uint8)EVoxelMemoryCategory::MAX; i++)
+		{
+			total += Bytes[i].GetValue();
+		}
+
+		return total;
+	}
+
+	// Takes ownership of InChunkData until it's removed or evicted
+	void Retain(FVoxelChunkNode* InNode, FVoxelDirtyChunkData* InChunkData);
+
+	// Marks the data as used, nullptr if not retained
+	FVoxelDirtyChunkData* FindRetained(FVoxelChunkNode* InNode);
+	bool IsRetained(const FVoxelChunkNode* InNode) const { return RetainedChunkData.Contains(const_cast<FVoxelChunkNode*>(InNode)); };
+
+	// Gives ownership back to the caller, nullptr if not retained
+	FVoxelDirtyChunkData* RemoveRetained(FVoxelChunkNode* InNode);
+	FVoxelDirtyChunkData* EvictLeastRecentlyUsed();
+
+	const int32 NumRetained() const { return RetainedChunkData.Num(); };
+
+	// Bytes of the retained chunk data, what eviction can give back
+	const int64 GetRetainedBytes() const { return RetainedBytes; };
+
+protected:
+
+	FThreadSafeCounter64 Bytes[(uint8)EVoxelMemoryCategory::MAX];
+
+	struct FRetainedChunkData
+	{
+		FVoxelDirtyChunkData* ChunkData = nullptr;
+		uint64 LastUsed = 0;
+	};
+
+	TMap<FVoxelChunkNode*, FRetainedChunkData> RetainedChunkData;
+	uint64 UseCounter = 0;
+	int64 RetainedBytes = 0;
+};
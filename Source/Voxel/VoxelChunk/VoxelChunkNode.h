@@ -4,6 +4,54 @@
 
 #include "CoreMinimal.h"
 
+#include "VoxelUtilities/VoxelDensityPyramid.h"
+
+// Identifies an octree position independently of the node living there, (depth, cell index at that depth)
+struct FVoxelChunkKey
+{
+	uint8 Depth = 0;
+	FIntVector Cell = FIntVector::ZeroValue;
+
+	FVoxelChunkKey() {};
+
+	FVoxelChunkKey(uint8 InDepth, const FVector& InLocation, double InVolumeExtent) :
+		Depth(InDepth)
+	{
+		const double chunkSize = InVolumeExtent * 2 / exp2(InDepth);
+		const FVector cell = (InLocation + InVolumeExtent) / chunkSize;
+		Cell = FIntVector(FMath::FloorToInt(cell.X), FMath::FloorToInt(cell.Y), FMath::FloorToInt(cell.Z));
+	}
+
+	bool operator==(const FVoxelChunkKey& Other) const
+	{
+		return Depth == Other.Depth && Cell == Other.Cell;
+	}
+
+	friend uint32 GetTypeHash(const FVoxelChunkKey& InKey)
+	{
+		return HashCombine(GetTypeHash(InKey.Depth), GetTypeHash(InKey.Cell));
+	}
+};
+
+// Where the volume is seen from, in the volume's space. Without a projection only the distance to Origin is used
+struct FVoxelLodView
+{
+	FVector Origin = FVector::ZeroVector;
+	FVector Forward = FVector::ForwardVector;
+
+	// Pixels per unit at a distance of one unit
+	double ProjectionScale = 0;
+
+	// Half angle of the cone around the view frustum
+	double HalfFovRadians = 0;
+
+	FVoxelLodView() {};
+
+	FVoxelLodView(const FVector& InOrigin) :
+		Origin(InOrigin) {};
+
+	const bool HasProjection() const { return ProjectionScale > 0; };
+};
 
 struct FVoxelChunkNode
 {
@@ -22,6 +70,9 @@ struct FVoxelChunkNode
 
 	short SectionID = 0;
 
+	// Min/max of the densities this node was last generated from, lets queries skip empty space
+	TUniquePtr<FVoxelDensityPyramid> DensityPyramid;
+
 	FVoxelChunkNode() :
 		Depth(0),
 		Location(FVector::ZeroVector) {};
@@ -55,6 +106,11 @@ struct FVoxelChunkNode
 		return FBox::BuildAABB(Location, FVector(GetExtent(InVolumeExtent)));
 	}
 
+	const FVoxelChunkKey GetKey(double InVolumeExtent) const
+	{
+		return FVoxelChunkKey(Depth, Location, InVolumeExtent);
+	}
+
 	const FVector GetChildCenter(int InChildIndex, double InVolumeExtent) const
 	{
 		return Location + NodeOffsets[InChildIndex] * GetExtent(InVolumeExtent);
@@ -72,9 +128,27 @@ struct FVoxelChunkNode
 		return distanceToNode < InLodFactor * chunkExtent * 2;
 	}
 
-	const FName GetSectionName()
+	// Size on screen, in pixels, of one voxel of this chunk, the error made by not subdividing it
+	const double GetScreenError(const FVoxelLodView& InView, double InVolumeExtent, int InChunkResolution) const
 	{
-		return MakeSectionName(SectionID);
+		const double distanceToNode = FMath::Sqrt(GetBox(InVolumeExtent).ComputeSquaredDistanceToPoint(InView.Origin));
+		const double voxelSize = GetExtent(InVolumeExtent) * 2 / InChunkResolution;
+
+		return voxelSize * InView.ProjectionScale / FMath::Max(distanceToNode, UE_KINDA_SMALL_NUMBER);
+	}
+
+	// Bounding sphere against the view cone, conservative near the frustum corners
+	const bool IsInView(const FVoxelLodView& InView, double InVolumeExtent) const
+	{
+		if (!InView.HasProjection()) return true;
+
+		const double radius = GetExtent(InVolumeExtent) * FMath::Sqrt(3.0);
+		const FVector toNode = Location - InView.Origin;
+		const double distance = toNode.Size();
+		if (distance <= radius) return true;
+
+		const double angle = FMath::Acos(FMath::Clamp(FVector::DotProduct(toNode / distance, InView.Forward), -1.0, 1.0));
+		return angle - FMath::Asin(radius / distance) <= InView.HalfFovRadians;
 	}
 
 	static const FName MakeSectionName(short InSectionID)
@@ -6,7 +6,13 @@
 
 #include "RealtimeMeshSimple.h"
 
+#include "VoxelChunk/VoxelChunkNode.h"
+#include "VoxelChunk/VoxelGenerationPipeline.h"
+#include "VoxelEdit/VoxelEditOp.h"
+#include "VoxelEdit/VoxelEditSnapshot.h"
+#include "VoxelScatter/VoxelScatter.h"
 #include "VoxelUtilities/Array3D.h"
+#include "VoxelUtilities/VoxelDensityPyramid.h"
 
 class AVoxelVolume;
 struct FVoxelDirtyChunkData;
@@ -22,11 +28,10 @@ struct FVoxelDirtyChunkData
 
 	~FVoxelDirtyChunkData()
 	{
-		if (tGeneration && (tGeneration->IsIdle() || tGeneration->Cancel()))
-			delete tGeneration;
-
 		CornerDensityValues.Empty();
+		ColumnValues.Empty();
 		StreamSet.Empty();
+		ScatterPoints.Empty();
 	}
 
 	void Init(
@@ -37,17 +42,69 @@ struct FVoxelDirtyChunkData
 	{
 		Chunk = InChunk;
 		BatchChunkKey = InBatchChunkKey;
-		CornerDensityValues = FArray3D<double>(FIntVector(InChunkResolution + 1), -1.0);
+		ChunkResolution = InChunkResolution;
+		// Padded rows, the mesher walks them with fixed corner offsets
+		CornerDensityValues = FArray3D<double>(FIntVector(InChunkResolution + 1), -1.0, EArray3DLayout::LinearPadded);
 	}
 
 	FVoxelChunkNode* Chunk = nullptr;
 	FVoxelChunkNode* BatchChunkKey = nullptr;
 
-	FAsyncTask<AsyncVoxelGenerateChunk>* tGeneration = nullptr;
-	FThreadSafeBool bMeshBuilt;
-	FThreadSafeBool bCollisionBuilt;
+	// Voxels per side, depends on the chunk's depth
+	int ChunkResolution = 0;
+
+	// Volume's BoundaryEpoch when the chunk was started, faces are shared with neighbours of the same epoch
+	uint32 BoundaryEpoch = 0;
+
+	// Corners between two meshed cells, above 1 while a coarse preview is generated ahead of the full resolution pass
+	int MeshStep = 1;
+
+	// Stand-in for Chunk when generated ahead of the octree (prefetch), kept alive as long as the data
+	TUniquePtr<FVoxelChunkNode> PrefetchNode;
+
+	// Next stage of the volume's generation pipeline, Done when nothing is left to run (or nothing was started)
+	EVoxelGenerationStage GenerationStage = EVoxelGenerationStage::Done;
+	EQueuedWorkPriority GenerationPriority = EQueuedWorkPriority::Normal;
+
+	// A pipeline worker is running GenerationStage
+	bool bStageRunning = false;
+
+	// Pipeline queue the chunk waits in, and its neighbours there, null when it isn't queued
+	FVoxelChunkQueue* PipelineQueue = nullptr;
+	FVoxelDirtyChunkData* PipelinePrev = nullptr;
+	FVoxelDirtyChunkData* PipelineNext = nullptr;
+
+	// Waits in the world scheduler's queue, not in the pipeline yet
+	bool bGenerationQueued = false;
+
+	// Set while the volume's batch tracker waits on its generation, 0 otherwise
+	uint32 GenerationId = 0;
+
+	// FPlatformTime::Seconds() when the chunk's node asked for it
+	double RequestTime = 0.0;
 
 	FArray3D<double> CornerDensityValues;
+
+	// Edits touching the chunk when it was started, applied on top of the generator with FVoxelEditOpGrid::Apply
+	TArray<FVoxelEditOp> EditOps;
+	TArray<TSharedPtr<const FVoxelEditSnapshot>> EditSnapshots;
+
+	// Cached column generator values, (x, y, generator index)
+	FArray3D<double> ColumnValues;
+
+	// Built once densities are filled, handed over to the node when the chunk is uploaded
+	TUniquePtr<FVoxelDensityPyramid> DensityPyramid;
+
 	FRealtimeMeshStreamSet StreamSet;
 	bool bHasAnyVertices = false;
+
+	// Surface points for the scatter layers, instanced with the chunk's section
+	TArray<FVoxelScatterPoint> ScatterPoints;
+
+	// Triangles written per material polygroup, a section is configured for each non-empty one
+	TArray<int32> MaterialTriangleCounts;
+
+	// Bytes currently counted in the volume's chunk memory, so releasing gives back exactly what was added
+	int64 DensityBytes = 0;
+	int64 StreamBytes = 0;
 };
\ No newline at end of file
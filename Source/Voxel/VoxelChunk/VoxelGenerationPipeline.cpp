@@ -0,0 +1,318 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "VoxelGenerationPipeline.h"
+
+#include "VoxelVolume.h"
+#include "VoxelChunk/AsyncVoxelGenerateChunk.h"
+#include "VoxelChunk/VoxelDirtyChunkData.h"
+
+void FVoxelChunkQueue::PushBack(FVoxelDirtyChunkData* InChunkData)
+{
+	check(!InChunkData->PipelineQueue);
+
+	InChunkData->PipelineQueue = this;
+	InChunkData->PipelinePrev = Tail;
+	InChunkData->PipelineNext = nullptr;
+
+	if (Tail) Tail->PipelineNext = InChunkData;
+	else Head = InChunkData;
+
+	Tail = InChunkData;
+	Count++;
+}
+
+FVoxelDirtyChunkData* FVoxelChunkQueue::PopFront()
+{
+	FVoxelDirtyChunkData* chunkData = Head;
+	if (chunkData) Remove(chunkData);
+
+	return chunkData;
+}
+
+void FVoxelChunkQueue::Remove(FVoxelDirtyChunkData* InChunkData)
+{
+	check(InChunkData->PipelineQueue == this);
+
+	if (InChunkData->PipelinePrev) InChunkData->PipelinePrev->PipelineNext = InChunkData->PipelineNext;
+	else Head = InChunkData->PipelineNext;
+
+	if (InChunkData->PipelineNext) InChunkData->PipelineNext->PipelinePrev = InChunkData->PipelinePrev;
+	else Tail = InChunkData->PipelinePrev;
+
+	InChunkData->PipelineQueue = nullptr;
+	InChunkData->PipelinePrev = nullptr;
+	InChunkData->PipelineNext = nullptr;
+	Count--;
+}
+
+void FVoxelChunkQueue::Reset()
+{
+	Head = nullptr;
+	Tail = nullptr;
+	Count = 0;
+}
+
+FVoxelGenerationPipeline::~FVoxelGenerationPipeline()
+{
+	// Chunk data is released before, workers only have their loop to finish
+	while (true)
+	{
+		{
+			FScopeLock scopeLock(&Lock);
+
+			for (FVoxelChunkQueue (&queues)[2] : StageQueues)
+			{
+				queues[0].Reset();
+				queues[1].Reset();
+			}
+
+			DensityBacklog[0].Reset();
+			DensityBacklog[1].Reset();
+
+			int32 numWorkers = 0;
+			for (int32 i = 0; i < NumStages; i++)
+			{
+				numWorkers += NumWorkers[i];
+			}
+
+			if (!numWorkers) return;
+		}
+
+		FPlatformProcess::Yield();
+	}
+}
+
+void FVoxelGenerationPipeline::SetBudgets(int32 InDensityWorkers, int32 InSurfaceWorkers, int32 InUploadPrepWorkers, int32 InQueueCapacity)
+{
+	FScopeLock scopeLock(&Lock);
+
+	WorkerBudgets[(int32)EVoxelGenerationStage::Density] = FMath::Max(1, InDensityWorkers);
+	WorkerBudgets[(int32)EVoxelGenerationStage::Surface] = FMath::Max(1, InSurfaceWorkers);
+	WorkerBudgets[(int32)EVoxelGenerationStage::UploadPrep] = FMath::Max(1, InUploadPrepWorkers);
+	QueueCapacity = FMath::Max(1, InQueueCapacity);
+
+	FillDensityQueue();
+	LaunchWorkers();
+}
+
+void FVoxelGenerationPipeline::Start(FVoxelDirtyChunkData* InChunkData, EQueuedWorkPriority InPriority)
+{
+	FScopeLock scopeLock(&Lock);
+
+	InChunkData->GenerationStage = EVoxelGenerationStage::Density;
+	InChunkData->GenerationPriority = InPriority;
+
+	const int32 idxDensity = (int32)EVoxelGenerationStage::Density;
+	if (GetNumInQueue(idxDensity) < QueueCapacity)
+	{
+		StageQueues[idxDensity][GetPriorityIndex(InPriority)].PushBack(InChunkData);
+	}
+	else
+	{
+		DensityBacklog[GetPriorityIndex(InPriority)].PushBack(InChunkData);
+	}
+
+	LaunchWorkers();
+}
+
+void FVoxelGenerationPipeline::Reprioritize(FVoxelDirtyChunkData* InChunkData, EQueuedWorkPriority InPriority)
+{
+	FScopeLock scopeLock(&Lock);
+
+	FVoxelChunkQueue* queue = InChunkData->PipelineQueue;
+	if (queue && InChunkData->GenerationPriority != InPriority)
+	{
+		// Moved to the other priority's queue, of the backlog when it's in it
+		const bool bBacklogged = queue == &DensityBacklog[0] || queue == &DensityBacklog[1];
+		FVoxelChunkQueue* queues = bBacklogged ? DensityBacklog : StageQueues[(int32)InChunkData->GenerationStage];
+
+		queue->Remove(InChunkData);
+		queues[GetPriorityIndex(InPriority)].PushBack(InChunkData);
+	}
+
+	InChunkData->GenerationPriority = InPriority;
+	LaunchWorkers();
+}
+
+bool FVoxelGenerationPipeline::IsDone(const FVoxelDirtyChunkData* InChunkData) const
+{
+	FScopeLock scopeLock(&Lock);
+	return InChunkData->GenerationStage == EVoxelGenerationStage::Done;
+}
+
+bool FVoxelGenerationPipeline::Cancel(FVoxelDirtyChunkData* InChunkData)
+{
+	FScopeLock scopeLock(&Lock);
+
+	if (InChunkData->bStageRunning || InChunkData->GenerationStage == EVoxelGenerationStage::Done) return false;
+
+	Unqueue(InChunkData);
+	InChunkData->GenerationStage = EVoxelGenerationStage::Done;
+
+	// Its slot in a bounded queue may be what a stage was waiting on
+	LaunchWorkers();
+	return true;
+}
+
+void FVoxelGenerationPipeline::EnsureCompletion(FVoxelDirtyChunkData* InChunkData)
+{
+	while (true)
+	{
+		EVoxelGenerationStage stage = EVoxelGenerationStage::Done;
+		{
+			FScopeLock scopeLock(&Lock);
+
+			if (InChunkData->GenerationStage == EVoxelGenerationStage::Done) return;
+
+			if (!InChunkData->bStageRunning)
+			{
+				stage = InChunkData->GenerationStage;
+				Unqueue(InChunkData);
+				InChunkData->bStageRunning = true;
+			}
+		}
+
+		// A worker has it, its next stage is taken from the queue once it's done
+		if (stage == EVoxelGenerationStage::Done)
+		{
+			FPlatformProcess::Yield();
+			continue;
+		}
+
+		Volume->RunGenerationStage(InChunkData, stage);
+
+		FScopeLock scopeLock(&Lock);
+		InChunkData->bStageRunning = false;
+		InChunkData->GenerationStage = (EVoxelGenerationStage)((int32)stage + 1);
+		if (InChunkData->GenerationStage == EVoxelGenerationStage::Done)
+		{
+			Volume->BatchTracker.Complete(InChunkData);
+		}
+
+		LaunchWorkers();
+	}
+}
+
+void FVoxelGenerationPipeline::Remove(FVoxelDirtyChunkData* InChunkData)
+{
+	while (!Cancel(InChunkData))
+	{
+		if (IsDone(InChunkData)) return;
+		FPlatformProcess::Yield();
+	}
+}
+
+int32 FVoxelGenerationPipeline::GetNumQueued(EVoxelGenerationStage InStage) const
+{
+	FScopeLock scopeLock(&Lock);
+	if (InStage == EVoxelGenerationStage::Done) return 0;
+
+	const int32 numBacklogged = InStage == EVoxelGenerationStage::Density ? DensityBacklog[0].Num() + DensityBacklog[1].Num() : 0;
+	return GetNumInQueue((int32)InStage) + numBacklogged;
+}
+
+void FVoxelGenerationPipeline::RunWorker(EVoxelGenerationStage InStage)
+{
+	const int32 idxStage = (int32)InStage;
+
+	while (true)
+	{
+		FVoxelDirtyChunkData* chunkData = nullptr;
+		{
+			FScopeLock scopeLock(&Lock);
+
+			if (!PopNext(idxStage, chunkData))
+			{
+				NumWorkers[idxStage]--;
+				return;
+			}
+
+			chunkData->bStageRunning = true;
+			NumRunning[idxStage]++;
+		}
+
+		Volume->RunGenerationStage(chunkData, InStage);
+
+		FScopeLock scopeLock(&Lock);
+		chunkData->bStageRunning = false;
+		NumRunning[idxStage]--;
+
+		const int32 idxNextStage = idxStage + 1;
+		chunkData->GenerationStage = (EVoxelGenerationStage)idxNextStage;
+		if (idxNextStage < NumStages)
+		{
+			StageQueues[idxNextStage][GetPriorityIndex(chunkData->GenerationPriority)].PushBack(chunkData);
+		}
+		else
+		{
+			Volume->BatchTracker.Complete(chunkData);
+		}
+
+		LaunchWorkers();
+	}
+}
+
+bool FVoxelGenerationPipeline::PopNext(int32 InStage, FVoxelDirtyChunkData*& OutChunkData)
+{
+	if (GetNumInQueue(InStage) == 0 || GetRoom(InStage) <= 0) return false;
+
+	// Oldest normal priority chunk, else the oldest one
+	FVoxelChunkQueue (&queues)[2] = StageQueues[InStage];
+	OutChunkData = queues[0].IsEmpty() ? queues[1].PopFront() : queues[0].PopFront();
+
+	if (InStage == (int32)EVoxelGenerationStage::Density)
+	{
+		FillDensityQueue();
+	}
+
+	return true;
+}
+
+void FVoxelGenerationPipeline::LaunchWorkers()
+{
+	for (int32 idxStage = 0; idxStage < NumStages; idxStage++)
+	{
+		const int32 numTakeable = FMath::Min(GetNumInQueue(idxStage), GetRoom(idxStage));
+
+		// Workers not running a chunk are about to take one
+		while (NumWorkers[idxStage] < WorkerBudgets[idxStage] && NumWorkers[idxStage] - NumRunning[idxStage] < numTakeable)
+		{
+			const bool bAnyNormal = !StageQueues[idxStage][0].IsEmpty();
+
+			NumWorkers[idxStage]++;
+			(new FAutoDeleteAsyncTask<AsyncVoxelGenerateChunk>(this, (EVoxelGenerationStage)idxStage))
+				->StartBackgroundTask(GThreadPool, bAnyNormal ? EQueuedWorkPriority::Normal : EQueuedWorkPriority::Low);
+		}
+	}
+}
+
+void FVoxelGenerationPipeline::Unqueue(FVoxelDirtyChunkData* InChunkData)
+{
+	if (!InChunkData->PipelineQueue) return;
+
+	InChunkData->PipelineQueue->Remove(InChunkData);
+
+	// Its slot in the density queue goes to the backlog
+	FillDensityQueue();
+}
+
+void FVoxelGenerationPipeline::FillDensityQueue()
+{
+	const int32 idxDensity = (int32)EVoxelGenerationStage::Density;
+
+	while (GetNumInQueue(idxDensity) < QueueCapacity)
+	{
+		FVoxelDirtyChunkData* chunkData = DensityBacklog[0].IsEmpty() ? DensityBacklog[1].PopFront() : DensityBacklog[0].PopFront();
+		if (!chunkData) return;
+
+		StageQueues[idxDensity][GetPriorityIndex(chunkData->GenerationPriority)].PushBack(chunkData);
+	}
+}
+
+int32 FVoxelGenerationPipeline::GetRoom(int32 InStage) const
+{
+	// The last stage hands its chunks back to the volume, not to a queue
+	if (InStage + 1 >= NumStages) return MAX_int32;
+
+	return QueueCapacity - GetNumInQueue(InStage + 1) - NumRunning[InStage];
+}
@@ -0,0 +1,113 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+class AVoxelVolume;
+struct FVoxelDirtyChunkData;
+
+enum class EVoxelGenerationStage : uint8
+{
+	// Corner densities, from the generator and edits
+	Density,
+	// Marching cubes into the chunk's streams
+	Surface,
+	// Index compaction, density pyramid and stream accounting, ready for the section update
+	UploadPrep,
+	// Nothing left to run
+	Done
+};
+
+// FIFO of chunks linked through their data, pushes, pops and removals are O(1). A chunk is in one queue at most
+struct FVoxelChunkQueue
+{
+	void PushBack(FVoxelDirtyChunkData* InChunkData);
+	FVoxelDirtyChunkData* PopFront();
+	void Remove(FVoxelDirtyChunkData* InChunkData);
+
+	// Forgets the chunks without touching them, for when they're already released
+	void Reset();
+
+	bool IsEmpty() const { return !Head; };
+	int32 Num() const { return Count; };
+
+private:
+
+	FVoxelDirtyChunkData* Head = nullptr;
+	FVoxelDirtyChunkData* Tail = nullptr;
+	int32 Count = 0;
+};
+
+// Generates chunks in stages, each with its own queue and worker budget, so one chunk's densities are sampled while
+// another is triangulated and a third prepared for upload. Every queue is bounded, a stage stops taking chunks while the
+// next one's queue is full, and started chunks past the density queue's capacity wait in a backlog until it has room.
+// Each queue is split by priority, so taking the next chunk never scans. Thread safe, the chunk data's stage fields
+// are only touched under its lock
+struct FVoxelGenerationPipeline
+{
+	static constexpr int32 NumStages = (int32)EVoxelGenerationStage::Done;
+
+	FVoxelGenerationPipeline(AVoxelVolume* InVolume) :
+		Volume(InVolume) {};
+
+	~FVoxelGenerationPipeline();
+
+	void SetBudgets(int32 InDensityWorkers, int32 InSurfaceWorkers, int32 InUploadPrepWorkers, int32 InQueueCapacity);
+
+	// Queues the chunk's density stage (or its backlog), low priority chunks are taken after every normal one
+	void Start(FVoxelDirtyChunkData* InChunkData, EQueuedWorkPriority InPriority);
+	void Reprioritize(FVoxelDirtyChunkData* InChunkData, EQueuedWorkPriority InPriority);
+
+	bool IsDone(const FVoxelDirtyChunkData* InChunkData) const;
+
+	// Takes the chunk out of the pipeline, false if a stage is running on it or it's done
+	bool Cancel(FVoxelDirtyChunkData* InChunkData);
+
+	// Runs the chunk's remaining stages on the calling thread, after the one running if any
+	void EnsureCompletion(FVoxelDirtyChunkData* InChunkData);
+
+	// Takes the chunk out of the pipeline, waiting on its running stage, before it's released
+	void Remove(FVoxelDirtyChunkData* InChunkData);
+
+	// Chunks waiting for the stage, the density stage's backlog included
+	int32 GetNumQueued(EVoxelGenerationStage InStage) const;
+
+	// Worker loop of a stage, runs chunks until its queue is empty or the next one is full
+	void RunWorker(EVoxelGenerationStage InStage);
+
+private:
+
+	// Normal priority queue first, then low
+	static int32 GetPriorityIndex(EQueuedWorkPriority InPriority) { return InPriority == EQueuedWorkPriority::Low ? 1 : 0; };
+
+	// All under Lock
+	bool PopNext(int32 InStage, FVoxelDirtyChunkData*& OutChunkData);
+	void LaunchWorkers();
+	void Unqueue(FVoxelDirtyChunkData* InChunkData);
+
+	// Moves backlogged chunks into the density queue while it has room, normal priority first
+	void FillDensityQueue();
+
+	int32 GetNumInQueue(int32 InStage) const { return StageQueues[InStage][0].Num() + StageQueues[InStage][1].Num(); };
+
+	// Chunks a stage can take before filling the next stage's queue
+	int32 GetRoom(int32 InStage) const;
+
+	AVoxelVolume* Volume = nullptr;
+
+	mutable FCriticalSection Lock;
+
+	// Per stage, normal and low priority
+	FVoxelChunkQueue StageQueues[NumStages][2];
+
+	// Started chunks the density queue had no room for, normal and low priority
+	FVoxelChunkQueue DensityBacklog[2];
+
+	// Workers alive per stage, and those of them running a chunk
+	int32 NumWorkers[NumStages] = {};
+	int32 NumRunning[NumStages] = {};
+
+	int32 WorkerBudgets[NumStages] = { 4, 3, 1 };
+	int32 QueueCapacity = 8;
+};
@@ -0,0 +1,58 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "VoxelSectionIdPool.h"
+
+#include "VoxelChunkNode.h"
+
+short FVoxelSectionIdPool::Acquire()
+{
+	if (!FreeSectionIDs.IsEmpty())
+	{
+		return FreeSectionIDs.Pop(false);
+	}
+
+	if (NextSectionID == MAX_int16)
+	{
+		UE_LOG(LogTemp, Error, TEXT("[FVoxelSectionIdPool::Acquire] Out of section IDs (%d in use)"), NumInUse());
+		return 0;
+	}
+
+	return NextSectionID++;
+}
+
+void FVoxelSectionIdPool::Release(short InSectionID)
+{
+	if (InSectionID > 0)
+	{
+		ReleasedSectionIDs.Add(InSectionID);
+	}
+}
+
+void FVoxelSectionIdPool::RecycleReleased()
+{
+	FreeSectionIDs.Append(ReleasedSectionIDs);
+	ReleasedSectionIDs.Reset();
+}
+
+const FName& FVoxelSectionIdPool::GetName(short InSectionID)
+{
+	if (SectionNames.Num() <= InSectionID)
+	{
+		SectionNames.SetNum(InSectionID + 1);
+	}
+
+	FName& name = SectionNames[InSectionID];
+	if (name.IsNone())
+	{
+		name = FVoxelChunkNode::MakeSectionName(InSectionID);
+	}
+
+	return name;
+}
+
+void FVoxelSectionIdPool::Reset()
+{
+	NextSectionID = 1;
+	FreeSectionIDs.Reset();
+	ReleasedSectionIDs.Reset();
+}
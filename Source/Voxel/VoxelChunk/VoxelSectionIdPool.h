@@ -0,0 +1,31 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+// Section IDs handed to chunk nodes, reused once released, with their section group names built once
+struct FVoxelSectionIdPool
+{
+	// 0 when every ID is taken
+	short Acquire();
+
+	// Only reusable after RecycleReleased, so a removal and a creation of the same name never share a section update
+	void Release(short InSectionID);
+	void RecycleReleased();
+
+	const FName& GetName(short InSectionID);
+
+	void Reset();
+
+	const int32 NumInUse() const { return NextSectionID - 1 - FreeSectionIDs.Num() - ReleasedSectionIDs.Num(); };
+
+protected:
+
+	short NextSectionID = 1;
+	TArray<short> FreeSectionIDs;
+	TArray<short> ReleasedSectionIDs;
+
+	// Indexed by section ID
+	TArray<FName> SectionNames;
+};
@@ -0,0 +1,93 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "VoxelSectionUpdateBatch.h"
+
+void FVoxelSectionUpdateBatch::AddCreate(
+	const FRealtimeMeshSectionGroupKey& InKey,
+	const FRealtimeMeshStreamSet& InStreamSet,
+	const TArray<int32>& InMaterialTriangleCounts,
+	bool bInCreateCollision,
+	bool bInIsVisible,
+	bool bInUpdateInPlace
+)
+{
+	FSectionGroupCreate& create = Creates.AddDefaulted_GetRef();
+	create.Key = InKey;
+	create.StreamSet = &InStreamSet;
+	create.bCreateCollision = bInCreateCollision;
+	create.bIsVisible = bInIsVisible;
+	create.bUpdateInPlace = bInUpdateInPlace;
+
+	// One section per material polygroup that received triangles
+	for (int32 idxPolyGroup = 0; idxPolyGroup < InMaterialTriangleCounts.Num(); idxPolyGroup++)
+	{
+		if (InMaterialTriangleCounts[idxPolyGroup])
+		{
+			create.PolyGroups.Add(idxPolyGroup);
+		}
+	}
+
+	if (create.PolyGroups.IsEmpty())
+	{
+		create.PolyGroups.Add(0);
+	}
+}
+
+void FVoxelSectionUpdateBatch::Apply(URealtimeMeshSimple* InRealtimeMesh, TFunction<void()> InOnComplete)
+{
+	if (!InRealtimeMesh || IsEmpty())
+	{
+		Reset();
+		if (InOnComplete) InOnComplete();
+		return;
+	}
+
+	int32 numUpdates = Removes.Num();
+	for (const FSectionGroupCreate& create : Creates)
+	{
+		numUpdates += 1 + create.PolyGroups.Num();
+	}
+
+	// A single continuation for the whole batch instead of one per update
+	TSharedRef<FThreadSafeCounter> pendingUpdates = MakeShared<FThreadSafeCounter>(numUpdates);
+	auto onUpdateFinished = [pendingUpdates, InOnComplete](ERealtimeMeshProxyUpdateStatus Status)
+	{
+		if (pendingUpdates->Decrement() == 0)
+		{
+			if (InOnComplete) InOnComplete();
+		}
+	};
+
+	for (const FSectionGroupCreate& create : Creates)
+	{
+		if (create.bUpdateInPlace)
+		{
+			InRealtimeMesh->UpdateSectionGroup(create.Key, *create.StreamSet).Next(onUpdateFinished);
+		}
+		else
+		{
+			InRealtimeMesh->CreateSectionGroup(create.Key, *create.StreamSet).Next(onUpdateFinished);
+		}
+
+		for (const int32 polyGroup : create.PolyGroups)
+		{
+			FRealtimeMeshSectionConfig sectionConfig(ERealtimeMeshSectionDrawType::Dynamic, polyGroup);
+			sectionConfig.bIsVisible = create.bIsVisible;
+			sectionConfig.bCastsShadow = create.bIsVisible;
+
+			InRealtimeMesh->UpdateSectionConfig
+			(
+				FRealtimeMeshSectionKey::CreateForPolyGroup(create.Key, polyGroup),
+				sectionConfig,
+				create.bCreateCollision
+			).Next(onUpdateFinished);
+		}
+	}
+
+	for (const FRealtimeMeshSectionGroupKey& key : Removes)
+	{
+		InRealtimeMesh->RemoveSectionGroup(key).Next(onUpdateFinished);
+	}
+
+	Reset();
+}
@@ -0,0 +1,59 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+#include "RealtimeMeshSimple.h"
+
+// Section group creations, in place updates and removals collected over a volume update, then issued together
+struct FVoxelSectionUpdateBatch
+{
+	struct FSectionGroupCreate
+	{
+		FRealtimeMeshSectionGroupKey Key;
+		const FRealtimeMeshStreamSet* StreamSet = nullptr;
+
+		// Polygroups that get a section config, polygroup index is also the material slot
+		TArray<int32, TInlineAllocator<4>> PolyGroups;
+
+		bool bCreateCollision = false;
+		bool bIsVisible = true;
+
+		// The group already exists, its streams are replaced without tearing down its proxy
+		bool bUpdateInPlace = false;
+	};
+
+	void AddCreate(
+		const FRealtimeMeshSectionGroupKey& InKey,
+		const FRealtimeMeshStreamSet& InStreamSet,
+		const TArray<int32>& InMaterialTriangleCounts,
+		bool bInCreateCollision,
+		bool bInIsVisible = true,
+		bool bInUpdateInPlace = false
+	);
+
+	void AddRemove(const FRealtimeMeshSectionGroupKey& InKey)
+	{
+		Removes.Add(InKey);
+	}
+
+	// Issues every update of the batch in one go, creations before removals so a LOD swap lands on the same frame.
+	// InOnComplete is called once, when the last update finished (may be off the game thread)
+	void Apply(URealtimeMeshSimple* InRealtimeMesh, TFunction<void()> InOnComplete = nullptr);
+
+	void Reset()
+	{
+		Creates.Reset();
+		Removes.Reset();
+	}
+
+	const bool IsEmpty() const { return Creates.IsEmpty() && Removes.IsEmpty(); };
+	const int32 NumCreates() const { return Creates.Num(); };
+	const int32 NumRemoves() const { return Removes.Num(); };
+
+protected:
+
+	TArray<FSectionGroupCreate> Creates;
+	TArray<FRealtimeMeshSectionGroupKey> Removes;
+};
@@ -0,0 +1,69 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "VoxelEditComponent.h"
+
+#include "VoxelVolume.h"
+
+UVoxelEditComponent::UVoxelEditComponent()
+{
+	SetIsReplicatedByDefault(true);
+}
+
+void UVoxelEditComponent::ApplyEdit(AVoxelVolume* Volume, EVoxelEditShape Shape, EVoxelEditOperation Operation, const FVector& WorldLocation, float Radius)
+{
+	if (!Volume) return;
+
+	if (GetOwner()->HasAuthority())
+	{
+		Volume->ApplyEdit(Shape, Operation, WorldLocation, Radius);
+	}
+	else
+	{
+		ServerApplyEdit(Volume, Shape, Operation, WorldLocation, Radius);
+	}
+}
+
+bool UVoxelEditComponent::ServerApplyEdit_Validate(AVoxelVolume* Volume, EVoxelEditShape Shape, EVoxelEditOperation Operation, const FVector_NetQuantize10& WorldLocation, float Radius)
+{
+	if (Shape > VES_Cube || Operation > VEO_Subtract) return false;
+	if (WorldLocation.ContainsNaN() || !FMath::IsFinite(Radius) || Radius <= 0.f) return false;
+
+	return !Volume || Radius <= Volume->MaxEditRadius;
+}
+
+void UVoxelEditComponent::ServerApplyEdit_Implementation(AVoxelVolume* Volume, EVoxelEditShape Shape, EVoxelEditOperation Operation, const FVector_NetQuantize10& WorldLocation, float Radius)
+{
+	if (!Volume) return;
+
+	// Edits that can't touch the volume would still be logged and sent to every client
+	if (!Volume->GetEditableBounds().ExpandBy(Radius).IsInside(WorldLocation)) return;
+
+	if (!ConsumeEditToken())
+	{
+		UE_LOG(LogTemp, Verbose, TEXT("[UVoxelEditComponent::ServerApplyEdit] Edit from %s dropped, over the rate limit"), *GetNameSafe(GetOwner()));
+		return;
+	}
+
+	Volume->ApplyEdit(Shape, Operation, WorldLocation, Radius);
+}
+
+bool UVoxelEditComponent::ConsumeEditToken()
+{
+	const double now = GetWorld()->GetRealTimeSeconds();
+
+	if (EditTokens < 0.f)
+	{
+		EditTokens = MaxEditBurst;
+	}
+	else
+	{
+		EditTokens = FMath::Min((float)MaxEditBurst, EditTokens + (float)(now - LastEditTokenTime) * MaxEditsPerSecond);
+	}
+
+	LastEditTokenTime = now;
+
+	if (EditTokens < 1.f) return false;
+
+	EditTokens -= 1.f;
+	return true;
+}
@@ -0,0 +1,47 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Components/ActorComponent.h"
+
+#include "VoxelEdit/VoxelEditOp.h"
+
+#include "VoxelEditComponent.generated.h"
+
+class AVoxelVolume;
+
+// Lets a client edit volumes it doesn't own, add it to the player controller or pawn. Edits go through the server,
+// which validates and throttles them per component (so per connection) before replicating them through the volume's edit regions
+UCLASS(ClassGroup = (Voxel), Meta = (BlueprintSpawnableComponent))
+class VOXEL_API UVoxelEditComponent : public UActorComponent
+{
+	GENERATED_BODY()
+
+public:
+
+	UVoxelEditComponent();
+
+	UFUNCTION(BlueprintCallable, Category = "Voxel|Edit")
+	void ApplyEdit(AVoxelVolume* Volume, EVoxelEditShape Shape, EVoxelEditOperation Operation, const FVector& WorldLocation, float Radius);
+
+	// Edits the server accepts from the client per second on average, the rest are dropped
+	UPROPERTY(BlueprintReadWrite, EditAnywhere, Category = "Voxel|Edit", Meta = (ClampMin = "0.1"))
+	float MaxEditsPerSecond = 10.f;
+
+	// Edits the client may send at once after being idle
+	UPROPERTY(BlueprintReadWrite, EditAnywhere, Category = "Voxel|Edit", Meta = (ClampMin = "1"))
+	int MaxEditBurst = 5;
+
+protected:
+
+	// Clients sending malformed edits (bad enums, non-finite or oversized radius) are disconnected
+	UFUNCTION(Server, Reliable, WithValidation)
+	void ServerApplyEdit(AVoxelVolume* Volume, EVoxelEditShape Shape, EVoxelEditOperation Operation, const FVector_NetQuantize10& WorldLocation, float Radius);
+
+	// Token bucket refilled at MaxEditsPerSecond up to MaxEditBurst, server side
+	bool ConsumeEditToken();
+
+	float EditTokens = -1.f;
+	double LastEditTokenTime = 0.0;
+};
@@ -0,0 +1,104 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "VoxelEditOp.h"
+
+#include "VoxelVolume.h"
+
+void FVoxelEditOp::Quantize()
+{
+	Location = FVector(
+		FMath::RoundToDouble(Location.X * QuantizationScale),
+		FMath::RoundToDouble(Location.Y * QuantizationScale),
+		FMath::RoundToDouble(Location.Z * QuantizationScale)
+	) / QuantizationScale;
+
+	Radius = FMath::Max(1, FMath::RoundToInt(Radius * QuantizationScale)) / QuantizationScale;
+}
+
+double FVoxelEditOp::Apply(const FVector& InLocation, double InDensity, double InThreshold) const
+{
+	// Chunks only gather the ops whose bounds reach them, so every chunk and query sees the same brush at a location
+	if (!GetBounds().IsInsideOrOn(InLocation)) return InDensity;
+
+	// Signed distance to the shape, negative inside
+	double distance;
+	if (Shape == VES_Cube)
+	{
+		const FVector q = (InLocation - Location).GetAbs() - Radius;
+		distance = q.ComponentMax(FVector::ZeroVector).Size() + FMath::Min(q.GetMax(), 0.0);
+	}
+	else
+	{
+		distance = (InLocation - Location).Size() - Radius;
+	}
+
+	// Normalized by the size, so a brush's falloff scales with it
+	const double brush = distance / Radius;
+
+	return Operation == VEO_Add
+		? FMath::Min(InDensity, InThreshold + brush)
+		: FMath::Max(InDensity, InThreshold - brush);
+}
+
+bool FVoxelEditOp::NetSerialize(FArchive& Ar, UPackageMap* Map, bool& bOutSuccess)
+{
+	// Shape and operation share a byte
+	uint8 flags = (Shape.GetValue() & 0x0F) | (Operation.GetValue() << 4);
+	Ar << flags;
+
+	if (Ar.IsLoading())
+	{
+		Shape = (EVoxelEditShape)(flags & 0x0F);
+		Operation = (EVoxelEditOperation)(flags >> 4);
+	}
+
+	Ar.SerializeIntPacked(Sequence);
+
+	// The quantized steps themselves, so nothing is clamped on the way. Zigzag encoded, small magnitudes stay short
+	bOutSuccess = true;
+	for (int axis = 0; axis < 3; axis++)
+	{
+		const double steps = FMath::RoundToDouble(Location[axis] * QuantizationScale);
+		bOutSuccess &= Ar.IsLoading() || FMath::Abs(steps) <= MAX_int32;
+
+		const int32 stepsQuantized = (int32)FMath::Clamp(steps, (double)-MAX_int32, (double)MAX_int32);
+		uint32 zigzag = ((uint32)stepsQuantized << 1) ^ (uint32)(stepsQuantized >> 31);
+		Ar.SerializeIntPacked(zigzag);
+
+		if (Ar.IsLoading())
+		{
+			Location[axis] = (int32)((zigzag >> 1) ^ (0u - (zigzag & 1))) / QuantizationScale;
+		}
+	}
+
+	uint32 radiusQuantized = FMath::Max(1, FMath::RoundToInt(Radius * QuantizationScale));
+	Ar.SerializeIntPacked(radiusQuantized);
+	if (Ar.IsLoading())
+	{
+		Radius = radiusQuantized / QuantizationScale;
+	}
+
+	return bOutSuccess && !Ar.IsError();
+}
+
+void FVoxelEditLog::Add(const FVoxelEditOp& InOp)
+{
+	FVoxelEditOpItem& item = Items.AddDefaulted_GetRef();
+	item.Op = InOp;
+	MarkItemDirty(item);
+}
+
+void FVoxelEditLog::PostReplicatedAdd(const TArrayView<int32>& AddedIndices, int32 FinalSize)
+{
+	if (!Owner) return;
+
+	TArray<FVoxelEditOp> ops;
+	ops.Reserve(AddedIndices.Num());
+
+	for (const int32 idx : AddedIndices)
+	{
+		ops.Add(Items[idx].Op);
+	}
+
+	Owner->AddEditOps(ops);
+}
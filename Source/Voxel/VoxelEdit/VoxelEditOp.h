@@ -0,0 +1,116 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Net/Serialization/FastArraySerializer.h"
+
+#include "VoxelEditOp.generated.h"
+
+class AVoxelVolume;
+
+UENUM(BlueprintType)
+enum EVoxelEditShape : uint8
+{
+	VES_Sphere,
+	VES_Cube
+};
+
+UENUM(BlueprintType)
+enum EVoxelEditOperation : uint8
+{
+	// Fills the shape
+	VEO_Add,
+	// Digs the shape out
+	VEO_Subtract
+};
+
+// One brush stroke on the density field, in the volume's space. Replicated quantized, and quantized the same way
+// before the server applies it, so every machine computes the same densities from it
+USTRUCT(BlueprintType)
+struct FVoxelEditOp
+{
+	GENERATED_BODY()
+public:
+	UPROPERTY(BlueprintReadWrite)
+	TEnumAsByte<EVoxelEditShape> Shape = VES_Sphere;
+
+	UPROPERTY(BlueprintReadWrite)
+	TEnumAsByte<EVoxelEditOperation> Operation = VEO_Subtract;
+
+	UPROPERTY(BlueprintReadWrite)
+	FVector Location = FVector::ZeroVector;
+
+	// Sphere radius or cube half extent
+	UPROPERTY(BlueprintReadWrite)
+	float Radius = 100.f;
+
+	// Order the server applied it in, ops are applied in this order everywhere
+	UPROPERTY()
+	uint32 Sequence = 0;
+
+	// Replicated precision, a tenth of a unit
+	static constexpr double QuantizationScale = 10.0;
+
+	void Quantize();
+
+	// Combines the brush with InDensity, the brush surface sits at InThreshold like the generated one. No effect outside the bounds
+	double Apply(const FVector& InLocation, double InDensity, double InThreshold) const;
+
+	FBox GetBounds() const
+	{
+		return FBox::BuildAABB(Location, FVector(Radius));
+	}
+
+	bool NetSerialize(FArchive& Ar, class UPackageMap* Map, bool& bOutSuccess);
+};
+
+template<>
+struct TStructOpsTypeTraits<FVoxelEditOp> : public TStructOpsTypeTraitsBase2<FVoxelEditOp>
+{
+	enum
+	{
+		WithNetSerializer = true,
+	};
+};
+
+USTRUCT()
+struct FVoxelEditOpItem : public FFastArraySerializerItem
+{
+	GENERATED_BODY()
+public:
+	UPROPERTY()
+	FVoxelEditOp Op;
+};
+
+// Ops of an AVoxelEditRegion. Delta replicated, so clients only receive new ops, and ops are removed once snapshots
+// cover them, so a late joiner only receives those since
+USTRUCT()
+struct FVoxelEditLog : public FFastArraySerializer
+{
+	GENERATED_BODY()
+public:
+	UPROPERTY()
+	TArray<FVoxelEditOpItem> Items;
+
+	// Told about ops received from the server
+	AVoxelVolume* Owner = nullptr;
+
+	void Add(const FVoxelEditOp& InOp);
+
+	void PostReplicatedAdd(const TArrayView<int32>& AddedIndices, int32 FinalSize);
+
+	bool NetDeltaSerialize(FNetDeltaSerializeInfo& DeltaParms)
+	{
+		return FFastArraySerializer::FastArrayDeltaSerialize<FVoxelEditOpItem, FVoxelEditLog>(Items, DeltaParms, *this);
+	}
+};
+
+template<>
+struct TStructOpsTypeTraits<FVoxelEditLog> : public TStructOpsTypeTraitsBase2<FVoxelEditLog>
+{
+	enum
+	{
+		WithNetDeltaSerializer = true,
+	};
+};
@@ -0,0 +1,266 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "VoxelEditOpGrid.h"
+
+#include "Algo/BinarySearch.h"
+#include "Algo/Sort.h"
+
+void FVoxelEditOpGrid::SetVolumeExtent(double InVolumeExtent)
+{
+	if (VolumeExtent == InVolumeExtent) return;
+
+	VolumeExtent = InVolumeExtent;
+	CellSize = VolumeExtent * 2 / (1 << CellDepth);
+
+	if (Snapshots.Num())
+	{
+		UE_LOG(LogTemp, Warning, TEXT("[FVoxelEditOpGrid::SetVolumeExtent] %d edit snapshots dropped, the edits they collapsed are lost"), Snapshots.Num());
+		Snapshots.Empty();
+	}
+
+	Buckets.Empty();
+	for (const FVoxelEditOp& op : Ops)
+	{
+		AddToBuckets(op);
+	}
+}
+
+bool FVoxelEditOpGrid::Add(const FVoxelEditOp& InOp)
+{
+	if (Algo::BinarySearchBy(Ops, InOp.Sequence, &FVoxelEditOp::Sequence) != INDEX_NONE || IsCollapsed(InOp)) return false;
+
+	InsertInOrder(Ops, InOp);
+	AddToBuckets(InOp);
+	return true;
+}
+
+void FVoxelEditOpGrid::AddSnapshot(const TSharedRef<const FVoxelEditSnapshot>& InSnapshot)
+{
+	if (InSnapshot->VolumeExtent != VolumeExtent) return; // baked for cells the grid no longer has
+
+	TSharedPtr<const FVoxelEditSnapshot>& snapshot = Snapshots.FindOrAdd(InSnapshot->Cell);
+	if (snapshot && snapshot->Sequence >= InSnapshot->Sequence) return;
+
+	snapshot = InSnapshot;
+
+	const uint32 sequence = InSnapshot->Sequence;
+	if (TArray<FVoxelEditOp>* bucket = Buckets.Find(InSnapshot->Cell))
+	{
+		bucket->RemoveAll([sequence](const FVoxelEditOp& InOp) { return InOp.Sequence < sequence; });
+		if (bucket->IsEmpty()) Buckets.Remove(InSnapshot->Cell);
+	}
+
+	Ops.RemoveAll([this](const FVoxelEditOp& InOp) { return IsCollapsed(InOp); });
+}
+
+void FVoxelEditOpGrid::Gather(const FBox& InBounds, TArray<FVoxelEditOp>& OutOps) const
+{
+	if (Ops.IsEmpty()) return;
+
+	const FIntVector minCell = GetCell(InBounds.Min);
+	const FIntVector maxCell = GetCell(InBounds.Max);
+	const FIntVector size = maxCell - minCell + FIntVector(1);
+
+	const int32 numOut = OutOps.Num();
+
+	// An op in several of the visited buckets is taken from each (it may be collapsed in some of them), duplicates are removed once sorted
+	auto GatherBucket = [&](const FIntVector& InCell, const TArray<FVoxelEditOp>& InBucket)
+	{
+		for (const FVoxelEditOp& op : InBucket)
+		{
+			if (InBounds.Intersect(op.GetBounds())) OutOps.Add(op);
+		}
+	};
+
+	// Coarse chunks span more cells than there are buckets
+	if ((int64)size.X * size.Y * size.Z > Buckets.Num())
+	{
+		for (const TPair<FIntVector, TArray<FVoxelEditOp>>& bucket : Buckets)
+		{
+			const FIntVector& cell = bucket.Key;
+			if (cell.X < minCell.X || cell.Y < minCell.Y || cell.Z < minCell.Z) continue;
+			if (cell.X > maxCell.X || cell.Y > maxCell.Y || cell.Z > maxCell.Z) continue;
+
+			GatherBucket(cell, bucket.Value);
+		}
+	}
+	else
+	{
+		for (int x = minCell.X; x <= maxCell.X; x++)
+		{
+			for (int y = minCell.Y; y <= maxCell.Y; y++)
+			{
+				for (int z = minCell.Z; z <= maxCell.Z; z++)
+				{
+					const FIntVector cell(x, y, z);
+					if (const TArray<FVoxelEditOp>* bucket = Buckets.Find(cell))
+					{
+						GatherBucket(cell, *bucket);
+					}
+				}
+			}
+		}
+	}
+
+	// Buckets are each in order, not across each other
+	TArrayView<FVoxelEditOp> gathered(OutOps.GetData() + numOut, OutOps.Num() - numOut);
+	Algo::SortBy(gathered, &FVoxelEditOp::Sequence);
+
+	int32 numUnique = numOut;
+	for (int32 idx = numOut; idx < OutOps.Num(); idx++)
+	{
+		if (numUnique == numOut || OutOps[numUnique - 1].Sequence != OutOps[idx].Sequence)
+		{
+			OutOps[numUnique++] = OutOps[idx];
+		}
+	}
+
+	OutOps.SetNum(numUnique, false);
+}
+
+void FVoxelEditOpGrid::GatherSnapshots(const FBox& InBounds, TArray<TSharedPtr<const FVoxelEditSnapshot>>& OutSnapshots) const
+{
+	const FIntVector minCell = GetCell(InBounds.Min);
+	const FIntVector maxCell = GetCell(InBounds.Max);
+
+	for (const TPair<FIntVector, TSharedPtr<const FVoxelEditSnapshot>>& snapshot : Snapshots)
+	{
+		const FIntVector& cell = snapshot.Key;
+		if (cell.X < minCell.X || cell.Y < minCell.Y || cell.Z < minCell.Z) continue;
+		if (cell.X > maxCell.X || cell.Y > maxCell.Y || cell.Z > maxCell.Z) continue;
+
+		OutSnapshots.Add(snapshot.Value);
+	}
+}
+
+double FVoxelEditOpGrid::Apply(const FVector& InLocation, double InDensity, double InThreshold) const
+{
+	if (IsEmpty()) return InDensity;
+
+	const FIntVector cell = GetCell(InLocation);
+
+	double density = InDensity;
+	if (const TSharedPtr<const FVoxelEditSnapshot>* snapshot = Snapshots.Find(cell))
+	{
+		density += (*snapshot)->SampleDelta(InLocation);
+	}
+
+	if (const TArray<FVoxelEditOp>* bucket = Buckets.Find(cell))
+	{
+		for (const FVoxelEditOp& op : *bucket)
+		{
+			density = op.Apply(InLocation, density, InThreshold);
+		}
+	}
+
+	return density;
+}
+
+double FVoxelEditOpGrid::Apply(TArrayView<const FVoxelEditOp> InOps, TArrayView<const TSharedPtr<const FVoxelEditSnapshot>> InSnapshots, const FVector& InLocation, double InDensity, double InThreshold)
+{
+	double density = InDensity;
+
+	// Ops gathered for a neighbouring cell may be in this cell's snapshot already
+	uint32 collapsedSequence = 0;
+	if (InSnapshots.Num())
+	{
+		const FIntVector cell = GetCell(InLocation, InSnapshots[0]->VolumeExtent);
+		for (const TSharedPtr<const FVoxelEditSnapshot>& snapshot : InSnapshots)
+		{
+			if (snapshot->Cell != cell) continue;
+
+			density += snapshot->SampleDelta(InLocation);
+			collapsedSequence = snapshot->Sequence;
+			break;
+		}
+	}
+
+	for (const FVoxelEditOp& op : InOps)
+	{
+		if (op.Sequence > collapsedSequence) density = op.Apply(InLocation, density, InThreshold);
+	}
+
+	return density;
+}
+
+void FVoxelEditOpGrid::Empty()
+{
+	Ops.Empty();
+	Buckets.Empty();
+	Snapshots.Empty();
+}
+
+bool FVoxelEditOpGrid::IsCollapsed(const FVoxelEditOp& InOp) const
+{
+	if (Snapshots.IsEmpty()) return false;
+
+	const FBox bounds = InOp.GetBounds();
+	const FIntVector minCell = GetCell(bounds.Min);
+	const FIntVector maxCell = GetCell(bounds.Max);
+
+	for (int x = minCell.X; x <= maxCell.X; x++)
+	{
+		for (int y = minCell.Y; y <= maxCell.Y; y++)
+		{
+			for (int z = minCell.Z; z <= maxCell.Z; z++)
+			{
+				const TSharedPtr<const FVoxelEditSnapshot> snapshot = Snapshots.FindRef(FIntVector(x, y, z));
+				if (!snapshot || snapshot->Sequence < InOp.Sequence) return false;
+			}
+		}
+	}
+
+	return true;
+}
+
+FIntVector FVoxelEditOpGrid::GetCell(const FVector& InLocation, double InVolumeExtent)
+{
+	// Outside the volume, clamped to its border cells
+	const int maxIndex = (1 << CellDepth) - 1;
+	const double cellSize = InVolumeExtent * 2 / (1 << CellDepth);
+	const FVector cell = (InLocation + FVector(InVolumeExtent)) / cellSize;
+
+	return FIntVector(
+		FMath::Clamp(FMath::FloorToInt(cell.X), 0, maxIndex),
+		FMath::Clamp(FMath::FloorToInt(cell.Y), 0, maxIndex),
+		FMath::Clamp(FMath::FloorToInt(cell.Z), 0, maxIndex)
+	);
+}
+
+void FVoxelEditOpGrid::InsertInOrder(TArray<FVoxelEditOp>& InOutOps, const FVoxelEditOp& InOp)
+{
+	// Almost always the last one
+	if (InOutOps.IsEmpty() || InOutOps.Last().Sequence < InOp.Sequence)
+	{
+		InOutOps.Add(InOp);
+		return;
+	}
+
+	InOutOps.Insert(InOp, Algo::UpperBoundBy(InOutOps, InOp.Sequence, &FVoxelEditOp::Sequence));
+}
+
+void FVoxelEditOpGrid::AddToBuckets(const FVoxelEditOp& InOp)
+{
+	if (VolumeExtent <= 0.0) return; // bucketed once the extent is set
+
+	const FBox bounds = InOp.GetBounds();
+	const FIntVector minCell = GetCell(bounds.Min);
+	const FIntVector maxCell = GetCell(bounds.Max);
+
+	for (int x = minCell.X; x <= maxCell.X; x++)
+	{
+		for (int y = minCell.Y; y <= maxCell.Y; y++)
+		{
+			for (int z = minCell.Z; z <= maxCell.Z; z++)
+			{
+				const FIntVector cell(x, y, z);
+
+				// Already in the cell's snapshot
+				const TSharedPtr<const FVoxelEditSnapshot> snapshot = Snapshots.FindRef(cell);
+				if (snapshot && snapshot->Sequence > InOp.Sequence) continue;
+
+				InsertInOrder(Buckets.FindOrAdd(cell), InOp);
+			}
+		}
+	}
+}
@@ -0,0 +1,78 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+#include "VoxelEdit/VoxelEditOp.h"
+#include "VoxelEdit/VoxelEditSnapshot.h"
+
+// Edit ops bucketed by a uniform grid over the volume, so chunks and queries only visit the ops near them.
+// An op is in the bucket of every cell its bounds touch, each bucket keeps sequence order. A cell's ops are
+// collapsed into a snapshot once there are too many, an op collapsed in every cell it touches is dropped
+struct FVoxelEditOpGrid
+{
+	// Cells per side are 1 << CellDepth, the size of the octree's nodes at that depth
+	static constexpr int CellDepth = 6;
+
+	// Rebuilds the buckets when the extent changed, snapshots were baked for the previous cells and are dropped
+	void SetVolumeExtent(double InVolumeExtent);
+
+	// Ops may arrive out of sequence order (replication), they are inserted in order. False for an op already added,
+	// or in a snapshot of every cell it touches (received again when its region became relevant again)
+	bool Add(const FVoxelEditOp& InOp);
+
+	// Replaces the ops before it in its cell, kept unless a later snapshot of the cell is already there
+	void AddSnapshot(const TSharedRef<const FVoxelEditSnapshot>& InSnapshot);
+
+	// Ops whose bounds intersect InBounds, appended in sequence order
+	void Gather(const FBox& InBounds, TArray<FVoxelEditOp>& OutOps) const;
+
+	// Snapshots of the cells intersecting InBounds
+	void GatherSnapshots(const FBox& InBounds, TArray<TSharedPtr<const FVoxelEditSnapshot>>& OutSnapshots) const;
+
+	// Applies InLocation's cell snapshot, then the ops of the cell in sequence order, each only affects its own bounds
+	double Apply(const FVector& InLocation, double InDensity, double InThreshold) const;
+
+	// Same as Apply, from what Gather and GatherSnapshots returned for bounds containing InLocation
+	static double Apply(TArrayView<const FVoxelEditOp> InOps, TArrayView<const TSharedPtr<const FVoxelEditSnapshot>> InSnapshots, const FVector& InLocation, double InDensity, double InThreshold);
+
+	void Empty();
+
+	// Ops not collapsed in every cell they touch yet
+	int32 Num() const { return Ops.Num(); };
+	int32 NumSnapshots() const { return Snapshots.Num(); };
+	bool IsEmpty() const { return Ops.IsEmpty() && Snapshots.IsEmpty(); };
+
+	const TArray<FVoxelEditOp>& GetOps() const { return Ops; };
+
+	// Ops of a cell after its snapshot, null without any
+	const TArray<FVoxelEditOp>* GetBucket(const FIntVector& InCell) const { return Buckets.Find(InCell); };
+	TSharedPtr<const FVoxelEditSnapshot> GetSnapshot(const FIntVector& InCell) const { return Snapshots.FindRef(InCell); };
+
+	// Whether every cell InOp touches has a snapshot after it
+	bool IsCollapsed(const FVoxelEditOp& InOp) const;
+
+	// Cell containing InLocation, those outside the volume are clamped to its border cells
+	FIntVector GetCell(const FVector& InLocation) const { return GetCell(InLocation, VolumeExtent); };
+	static FIntVector GetCell(const FVector& InLocation, double InVolumeExtent);
+
+	double GetCellSize() const { return CellSize; };
+
+protected:
+
+	static void InsertInOrder(TArray<FVoxelEditOp>& InOutOps, const FVoxelEditOp& InOp);
+
+	void AddToBuckets(const FVoxelEditOp& InOp);
+
+	double VolumeExtent = 0.0;
+	double CellSize = 1.0;
+
+	// Every op in sequence order, the buckets are rebuilt from it
+	TArray<FVoxelEditOp> Ops;
+
+	TMap<FIntVector, TArray<FVoxelEditOp>> Buckets;
+
+	// Latest snapshot of each cell, the ops before it are out of the cell's bucket
+	TMap<FIntVector, TSharedPtr<const FVoxelEditSnapshot>> Snapshots;
+};
@@ -0,0 +1,176 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "VoxelEditRegion.h"
+
+#include "Algo/Count.h"
+#include "Misc/Compression.h"
+#include "Net/UnrealNetwork.h"
+
+#include "VoxelVolume.h"
+#include "VoxelEdit/VoxelEditOpGrid.h"
+
+bool FVoxelEditBrickBytes::NetSerialize(FArchive& Ar, UPackageMap* Map, bool& bOutSuccess)
+{
+	uint32 numBytes = Bytes.Num();
+	Ar.SerializeIntPacked(numBytes);
+
+	// Zlib never grows a brick past its bound
+	bOutSuccess = numBytes <= (uint32)FCompression::CompressMemoryBound(NAME_Zlib, FVoxelEditSnapshot::BrickPoints * sizeof(float));
+	if (!bOutSuccess)
+	{
+		Ar.SetError();
+		return false;
+	}
+
+	if (Ar.IsLoading())
+	{
+		Bytes.SetNumUninitialized(numBytes);
+	}
+
+	Ar.Serialize(Bytes.GetData(), numBytes);
+
+	return !Ar.IsError();
+}
+
+void FVoxelEditBrickArray::PostReplicatedAdd(const TArrayView<int32>& AddedIndices, int32 FinalSize)
+{
+	if (Owner) Owner->TryInstallSnapshot();
+}
+
+AVoxelEditRegion::AVoxelEditRegion()
+{
+	PrimaryActorTick.bCanEverTick = false;
+
+	// Placed at the cell's centre, for relevancy
+	RootComponent = CreateDefaultSubobject<USceneComponent>(TEXT("Root"));
+
+	bReplicates = true;
+	bAlwaysRelevant = true;
+	SnapshotBricks.Owner = this;
+}
+
+void AVoxelEditRegion::GetLifetimeReplicatedProps(TArray<FLifetimeProperty>& OutLifetimeProps) const
+{
+	Super::GetLifetimeReplicatedProps(OutLifetimeProps);
+
+	DOREPLIFETIME_CONDITION(AVoxelEditRegion, Volume, COND_InitialOnly);
+	DOREPLIFETIME_CONDITION(AVoxelEditRegion, Cell, COND_InitialOnly);
+	DOREPLIFETIME(AVoxelEditRegion, Log);
+	DOREPLIFETIME(AVoxelEditRegion, SnapshotInfo);
+	DOREPLIFETIME(AVoxelEditRegion, SnapshotBricks);
+}
+
+void AVoxelEditRegion::Init(AVoxelVolume* InVolume, const FIntVector& InCell)
+{
+	Volume = InVolume;
+	Cell = InCell;
+
+	const double cellSize = InVolume->VolumeExtent * 2 / (1 << FVoxelEditOpGrid::CellDepth);
+	const FTransform& volumeTransform = InVolume->GetActorTransform();
+	SetActorLocation(volumeTransform.TransformPosition((FVector(InCell) + 0.5) * cellSize - InVolume->VolumeExtent));
+
+	// Measured from the cell's bounds, its centre is half a diagonal further
+	if (InVolume->EditRelevancyDistance > 0.f)
+	{
+		const double halfDiagonal = cellSize * 0.5 * UE_DOUBLE_SQRT_3 * volumeTransform.GetMaximumAxisScale();
+
+		bAlwaysRelevant = false;
+		NetCullDistanceSquared = FMath::Square(InVolume->EditRelevancyDistance + halfDiagonal);
+	}
+}
+
+void AVoxelEditRegion::AddOp(const FVoxelEditOp& InOp)
+{
+	Log.Add(InOp);
+}
+
+void AVoxelEditRegion::SetSnapshot(const FVoxelEditSnapshot& InSnapshot, TArray<FVoxelEditBrickItem>&& InBricks)
+{
+	SnapshotBricks.Items.Reset();
+	for (FVoxelEditBrickItem& brick : InBricks)
+	{
+		FVoxelEditBrickItem& item = SnapshotBricks.Items.Add_GetRef(MoveTemp(brick));
+		SnapshotBricks.MarkItemDirty(item);
+	}
+
+	// The previous bricks are gone with it
+	SnapshotBricks.MarkArrayDirty();
+
+	SnapshotInfo.Sequence = InSnapshot.Sequence;
+	SnapshotInfo.NumBricks = SnapshotBricks.Items.Num();
+	SnapshotInfo.NumPoints = InSnapshot.NumPoints;
+	InstalledSequence = InSnapshot.Sequence;
+}
+
+void AVoxelEditRegion::RemoveCollapsedOps(const FVoxelEditOpGrid& InGrid)
+{
+	const int32 numRemoved = Log.Items.RemoveAll([&InGrid](const FVoxelEditOpItem& InItem) { return InGrid.IsCollapsed(InItem.Op); });
+	if (numRemoved) Log.MarkArrayDirty();
+}
+
+void AVoxelEditRegion::BeginPlay()
+{
+	Super::BeginPlay();
+
+	if (!HasAuthority()) RegisterWithVolume();
+}
+
+void AVoxelEditRegion::OnRep_Volume()
+{
+	RegisterWithVolume();
+}
+
+void AVoxelEditRegion::OnRep_SnapshotInfo()
+{
+	TryInstallSnapshot();
+}
+
+void AVoxelEditRegion::RegisterWithVolume()
+{
+	if (bRegistered || !Volume || !HasActorBegunPlay()) return;
+
+	bRegistered = true;
+	Log.Owner = Volume;
+
+	// Ops already in a snapshot the volume has, from a previous time the region was relevant, are skipped by it
+	TArray<FVoxelEditOp> ops;
+	ops.Reserve(Log.Items.Num());
+
+	for (const FVoxelEditOpItem& item : Log.Items)
+	{
+		ops.Add(item.Op);
+	}
+
+	Volume->AddEditOps(ops);
+	TryInstallSnapshot();
+}
+
+void AVoxelEditRegion::TryInstallSnapshot()
+{
+	if (!bRegistered || SnapshotInfo.Sequence <= InstalledSequence) return;
+
+	const uint32 sequence = SnapshotInfo.Sequence;
+	const int32 numBricks = Algo::CountIf(SnapshotBricks.Items, [sequence](const FVoxelEditBrickItem& InItem) { return InItem.Sequence == sequence; });
+	if (numBricks < SnapshotInfo.NumBricks) return;
+
+	TSharedRef<FVoxelEditSnapshot> snapshot = MakeShared<FVoxelEditSnapshot>();
+	snapshot->InitLattice(Cell, Volume->VolumeExtent, SnapshotInfo.NumPoints);
+	snapshot->Sequence = sequence;
+
+	for (const FVoxelEditBrickItem& item : SnapshotBricks.Items)
+	{
+		if (item.Sequence != sequence) continue;
+
+		TArray<float> deltas;
+		if (!FVoxelEditSnapshot::DecompressBrick(item.Data.Bytes, deltas))
+		{
+			UE_LOG(LogTemp, Warning, TEXT("[AVoxelEditRegion::TryInstallSnapshot] Brick %s of cell %s doesn't decompress"), *item.Brick.ToString(), *Cell.ToString());
+			return;
+		}
+
+		snapshot->Bricks.Add(item.Brick, MoveTemp(deltas));
+	}
+
+	InstalledSequence = sequence;
+	Volume->AddEditSnapshot(snapshot);
+}
@@ -0,0 +1,157 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "GameFramework/Actor.h"
+#include "Net/Serialization/FastArraySerializer.h"
+
+#include "VoxelEdit/VoxelEditOp.h"
+#include "VoxelEdit/VoxelEditSnapshot.h"
+
+#include "VoxelEditRegion.generated.h"
+
+class AVoxelEditRegion;
+class AVoxelVolume;
+struct FVoxelEditOpGrid;
+
+// Compressed deltas of a snapshot brick, written as is so the size limit of replicated arrays doesn't apply
+USTRUCT()
+struct FVoxelEditBrickBytes
+{
+	GENERATED_BODY()
+public:
+	TArray<uint8> Bytes;
+
+	bool NetSerialize(FArchive& Ar, class UPackageMap* Map, bool& bOutSuccess);
+};
+
+template<>
+struct TStructOpsTypeTraits<FVoxelEditBrickBytes> : public TStructOpsTypeTraitsBase2<FVoxelEditBrickBytes>
+{
+	enum
+	{
+		WithNetSerializer = true,
+	};
+};
+
+USTRUCT()
+struct FVoxelEditBrickItem : public FFastArraySerializerItem
+{
+	GENERATED_BODY()
+public:
+	UPROPERTY()
+	FIntVector Brick = FIntVector::ZeroValue;
+
+	// Snapshot the brick is part of
+	UPROPERTY()
+	uint32 Sequence = 0;
+
+	UPROPERTY()
+	FVoxelEditBrickBytes Data;
+};
+
+// Bricks of a region's latest snapshot
+USTRUCT()
+struct FVoxelEditBrickArray : public FFastArraySerializer
+{
+	GENERATED_BODY()
+public:
+	UPROPERTY()
+	TArray<FVoxelEditBrickItem> Items;
+
+	// Told about bricks received from the server
+	AVoxelEditRegion* Owner = nullptr;
+
+	void PostReplicatedAdd(const TArrayView<int32>& AddedIndices, int32 FinalSize);
+
+	bool NetDeltaSerialize(FNetDeltaSerializeInfo& DeltaParms)
+	{
+		return FFastArraySerializer::FastArrayDeltaSerialize<FVoxelEditBrickItem, FVoxelEditBrickArray>(Items, DeltaParms, *this);
+	}
+};
+
+template<>
+struct TStructOpsTypeTraits<FVoxelEditBrickArray> : public TStructOpsTypeTraitsBase2<FVoxelEditBrickArray>
+{
+	enum
+	{
+		WithNetDeltaSerializer = true,
+	};
+};
+
+// Snapshot the replicated bricks make up, a client installs it once it has all of them
+USTRUCT()
+struct FVoxelEditSnapshotInfo
+{
+	GENERATED_BODY()
+public:
+	UPROPERTY()
+	uint32 Sequence = 0;
+
+	UPROPERTY()
+	int32 NumBricks = 0;
+
+	UPROPERTY()
+	int32 NumPoints = 0;
+};
+
+// Replicates the edits of one FVoxelEditOpGrid cell of a volume: the ops centred in it, and the snapshot its ops were
+// collapsed into. Spawned by the server when the cell gets its first op or snapshot, an actor of its own so each region
+// has its own relevancy (see AVoxelVolume::EditRelevancyDistance). A late joiner receives the regions relevant to it,
+// each a snapshot and the ops since, separately
+UCLASS(NotPlaceable, Transient)
+class VOXEL_API AVoxelEditRegion : public AActor
+{
+	GENERATED_BODY()
+
+public:
+
+	AVoxelEditRegion();
+
+	// Server side
+	void Init(AVoxelVolume* InVolume, const FIntVector& InCell);
+	void AddOp(const FVoxelEditOp& InOp);
+
+	// Replaces the previous snapshot's bricks, InBricks were compressed with the bake
+	void SetSnapshot(const FVoxelEditSnapshot& InSnapshot, TArray<FVoxelEditBrickItem>&& InBricks);
+
+	// Ops every cell they touch has collapsed aren't sent to late joiners anymore
+	void RemoveCollapsedOps(const FVoxelEditOpGrid& InGrid);
+
+	// Client side, hands the snapshot to the volume once all its bricks arrived
+	void TryInstallSnapshot();
+
+protected:
+
+	virtual void BeginPlay() override;
+	virtual void GetLifetimeReplicatedProps(TArray<FLifetimeProperty>& OutLifetimeProps) const override;
+
+	UFUNCTION()
+	void OnRep_Volume();
+
+	UFUNCTION()
+	void OnRep_SnapshotInfo();
+
+	// Hands what was received before the volume was to it
+	void RegisterWithVolume();
+
+	UPROPERTY(ReplicatedUsing = OnRep_Volume)
+	TObjectPtr<AVoxelVolume> Volume;
+
+	UPROPERTY(Replicated)
+	FIntVector Cell = FIntVector::ZeroValue;
+
+	// Ops centred in the cell that some cell they touch still needs
+	UPROPERTY(Replicated)
+	FVoxelEditLog Log;
+
+	UPROPERTY(ReplicatedUsing = OnRep_SnapshotInfo)
+	FVoxelEditSnapshotInfo SnapshotInfo;
+
+	UPROPERTY(Replicated)
+	FVoxelEditBrickArray SnapshotBricks;
+
+	uint32 InstalledSequence = 0;
+	bool bRegistered = false;
+};
@@ -0,0 +1,167 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "VoxelEditSnapshot.h"
+
+#include "Async/ParallelFor.h"
+#include "Misc/Compression.h"
+
+#include "VoxelEdit/VoxelEditOpGrid.h"
+#include "VoxelProceduralGeneration/VoxelProceduralGenerator.h"
+
+void FVoxelEditSnapshot::InitLattice(const FIntVector& InCell, double InVolumeExtent, int32 InNumPoints)
+{
+	const double cellSize = InVolumeExtent * 2 / (1 << FVoxelEditOpGrid::CellDepth);
+
+	Cell = InCell;
+	VolumeExtent = InVolumeExtent;
+	Min = FVector(InCell) * cellSize - InVolumeExtent;
+	NumPoints = FMath::Max(InNumPoints, 2);
+	Spacing = cellSize / (NumPoints - 1);
+}
+
+int32 FVoxelEditSnapshot::GetNumPoints(double InCellSize, double InVoxelSize)
+{
+	return FMath::Clamp(FMath::RoundToInt(InCellSize / InVoxelSize), 1, 1 << 14) + 1;
+}
+
+bool FVoxelEditSnapshot::Bake(UVoxelProceduralGenerator* InGenerator, double InThreshold, const FVoxelEditSnapshot* InPrevious, TArrayView<const FVoxelEditOp> InOps)
+{
+	// Bricks the ops or the previous snapshot reach, the deltas are 0 everywhere else
+	TSet<FIntVector> brickKeys;
+	if (InPrevious)
+	{
+		for (const TPair<FIntVector, TArray<float>>& brick : InPrevious->Bricks)
+		{
+			brickKeys.Add(brick.Key);
+		}
+	}
+
+	const double lastPoint = NumPoints - 1;
+	for (const FVoxelEditOp& op : InOps)
+	{
+		const FBox bounds = op.GetBounds();
+		const FVector minPoint = ((bounds.Min - Min) / Spacing).BoundToBox(FVector::ZeroVector, FVector(lastPoint));
+		const FVector maxPoint = ((bounds.Max - Min) / Spacing).BoundToBox(FVector::ZeroVector, FVector(lastPoint));
+
+		const FIntVector minBrick(FMath::FloorToInt(minPoint.X) / BrickSize, FMath::FloorToInt(minPoint.Y) / BrickSize, FMath::FloorToInt(minPoint.Z) / BrickSize);
+		const FIntVector maxBrick(FMath::CeilToInt(maxPoint.X) / BrickSize, FMath::CeilToInt(maxPoint.Y) / BrickSize, FMath::CeilToInt(maxPoint.Z) / BrickSize);
+
+		for (int x = minBrick.X; x <= maxBrick.X; x++)
+		{
+			for (int y = minBrick.Y; y <= maxBrick.Y; y++)
+			{
+				for (int z = minBrick.Z; z <= maxBrick.Z; z++)
+				{
+					brickKeys.Add(FIntVector(x, y, z));
+				}
+			}
+		}
+
+		if (brickKeys.Num() > MaxBricks) return false;
+	}
+
+	const TArray<FIntVector> bricks = brickKeys.Array();
+	TArray<TArray<float>> deltas;
+	deltas.SetNum(bricks.Num());
+
+	// Each brick only writes its own deltas
+	ParallelFor(bricks.Num(), [&](int32 idxBrick)
+		{
+			const FIntVector brickMin = bricks[idxBrick] * BrickSize;
+			TArray<float>& brickDeltas = deltas[idxBrick];
+			brickDeltas.SetNumZeroed(BrickPoints);
+
+			for (int x = 0; x < BrickSize && brickMin.X + x < NumPoints; x++)
+			{
+				for (int y = 0; y < BrickSize && brickMin.Y + y < NumPoints; y++)
+				{
+					for (int z = 0; z < BrickSize && brickMin.Z + z < NumPoints; z++)
+					{
+						const FIntVector point = brickMin + FIntVector(x, y, z);
+						const FVector location = Min + FVector(point) * Spacing;
+
+						const double generated = InGenerator->GenerateProceduralValue(location, VolumeExtent);
+						double density = InPrevious ? generated + InPrevious->GetDelta(point.X, point.Y, point.Z) : generated;
+						for (const FVoxelEditOp& op : InOps)
+						{
+							density = op.Apply(location, density, InThreshold);
+						}
+
+						brickDeltas[(x * BrickSize + y) * BrickSize + z] = density - generated;
+					}
+				}
+			}
+		}
+	);
+
+	// Ops that didn't change anything there, an Add where the terrain already was for instance
+	for (int32 idxBrick = 0; idxBrick < bricks.Num(); idxBrick++)
+	{
+		if (deltas[idxBrick].ContainsByPredicate([](float InDelta) { return InDelta != 0.f; }))
+		{
+			Bricks.Add(bricks[idxBrick], MoveTemp(deltas[idxBrick]));
+		}
+	}
+
+	return true;
+}
+
+double FVoxelEditSnapshot::SampleDelta(const FVector& InLocation) const
+{
+	const FVector point = ((InLocation - Min) / Spacing).BoundToBox(FVector::ZeroVector, FVector(NumPoints - 1));
+	const int x = FMath::Min(FMath::FloorToInt(point.X), NumPoints - 2);
+	const int y = FMath::Min(FMath::FloorToInt(point.Y), NumPoints - 2);
+	const int z = FMath::Min(FMath::FloorToInt(point.Z), NumPoints - 2);
+	const FVector alpha = point - FVector(x, y, z);
+
+	const double c00 = FMath::Lerp<double>(GetDelta(x, y, z), GetDelta(x + 1, y, z), alpha.X);
+	const double c01 = FMath::Lerp<double>(GetDelta(x, y, z + 1), GetDelta(x + 1, y, z + 1), alpha.X);
+	const double c10 = FMath::Lerp<double>(GetDelta(x, y + 1, z), GetDelta(x + 1, y + 1, z), alpha.X);
+	const double c11 = FMath::Lerp<double>(GetDelta(x, y + 1, z + 1), GetDelta(x + 1, y + 1, z + 1), alpha.X);
+
+	return FMath::Lerp(FMath::Lerp(c00, c10, alpha.Y), FMath::Lerp(c01, c11, alpha.Y), alpha.Z);
+}
+
+FBox FVoxelEditSnapshot::GetEditedBounds() const
+{
+	const double brickSize = Spacing * BrickSize;
+
+	FBox bounds(ForceInit);
+	for (const TPair<FIntVector, TArray<float>>& brick : Bricks)
+	{
+		const FVector brickMin = Min + FVector(brick.Key) * brickSize;
+		bounds += FBox(brickMin, brickMin + brickSize);
+	}
+
+	return bounds;
+}
+
+bool FVoxelEditSnapshot::CompressBrick(TArrayView<const float> InDeltas, TArray<uint8>& OutBytes)
+{
+	const int32 numBytes = InDeltas.Num() * sizeof(float);
+	int32 compressedSize = FCompression::CompressMemoryBound(NAME_Zlib, numBytes);
+	OutBytes.SetNumUninitialized(compressedSize);
+
+	if (!FCompression::CompressMemory(NAME_Zlib, OutBytes.GetData(), compressedSize, InDeltas.GetData(), numBytes))
+	{
+		OutBytes.Reset();
+		return false;
+	}
+
+	OutBytes.SetNum(compressedSize);
+	return true;
+}
+
+bool FVoxelEditSnapshot::DecompressBrick(TArrayView<const uint8> InBytes, TArray<float>& OutDeltas)
+{
+	OutDeltas.SetNumUninitialized(BrickPoints);
+	return FCompression::UncompressMemory(NAME_Zlib, OutDeltas.GetData(), BrickPoints * sizeof(float), InBytes.GetData(), InBytes.Num());
+}
+
+float FVoxelEditSnapshot::GetDelta(int InX, int InY, int InZ) const
+{
+	const TArray<float>* brick = Bricks.Find(FIntVector(InX / BrickSize, InY / BrickSize, InZ / BrickSize));
+	if (!brick) return 0.f;
+
+	return (*brick)[((InX % BrickSize) * BrickSize + InY % BrickSize) * BrickSize + InZ % BrickSize];
+}
@@ -0,0 +1,65 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+#include "VoxelEdit/VoxelEditOp.h"
+
+class UVoxelProceduralGenerator;
+
+// Density the edits of one FVoxelEditOpGrid cell changed, up to a sequence, on a lattice of the volume's finest voxels so
+// chunk corners land on it. It stands in for those ops: the density at a location of the cell is the generator's plus the
+// interpolated delta, then the cell's later ops. Immutable once baked, chunks generating off the game thread share it
+struct FVoxelEditSnapshot
+{
+	// Lattice points per brick side, only the bricks the edits changed are kept
+	static constexpr int BrickSize = 16;
+	static constexpr int BrickPoints = BrickSize * BrickSize * BrickSize;
+
+	// Most bricks a snapshot may have, so a region's replicated bricks stay under the fast array's changes per update
+	static constexpr int MaxBricks = 1024;
+
+	FIntVector Cell = FIntVector::ZeroValue;
+
+	// Ops before it are in the snapshot, those after are applied on top. Taken by the server from the edit sequence,
+	// so it's no op's and faces sampled before and after the snapshot never share
+	uint32 Sequence = 0;
+
+	// Lattice over the cell, its high faces included
+	double VolumeExtent = 0.0;
+	FVector Min = FVector::ZeroVector;
+	double Spacing = 1.0;
+	int32 NumPoints = 0;
+
+	// Deltas of each brick, x major. Missing bricks are all 0
+	TMap<FIntVector, TArray<float>> Bricks;
+
+	void InitLattice(const FIntVector& InCell, double InVolumeExtent, int32 InNumPoints);
+
+	// Lattice points per side for cells of InCellSize, one per voxel of InVoxelSize
+	static int32 GetNumPoints(double InCellSize, double InVoxelSize);
+
+	// Applies InOps, in sequence order and all after InPrevious (the cell's last snapshot, if any), on top of it.
+	// False when they reach more than MaxBricks
+	bool Bake(UVoxelProceduralGenerator* InGenerator, double InThreshold, const FVoxelEditSnapshot* InPrevious, TArrayView<const FVoxelEditOp> InOps);
+
+	// Trilinear between the lattice points around InLocation, exact on them
+	double SampleDelta(const FVector& InLocation) const;
+
+	FBox GetBounds() const
+	{
+		return FBox(Min, Min + Spacing * (NumPoints - 1));
+	}
+
+	// Box of the stored bricks, where the snapshot differs from the generator
+	FBox GetEditedBounds() const;
+
+	// Zlib over a brick's deltas, what is replicated
+	static bool CompressBrick(TArrayView<const float> InDeltas, TArray<uint8>& OutBytes);
+	static bool DecompressBrick(TArrayView<const uint8> InBytes, TArray<float>& OutDeltas);
+
+protected:
+
+	float GetDelta(int InX, int InY, int InZ) const;
+};
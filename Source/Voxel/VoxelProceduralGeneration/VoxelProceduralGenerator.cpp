@@ -1,3 +1,18 @@
 // Fill out your copyright notice in the Description page of Project Settings.
 
-#include "VoxelProceduralGenerator.h"
\ No newline at end of file
+#include "VoxelProceduralGenerator.h"
+
+uint32 UVoxelProceduralGenerator::HashSettings(const UObject* InGenerator)
+{
+    if (!InGenerator) return 0;
+
+    uint32 hash = GetTypeHash(InGenerator->GetClass()->GetFName());
+    for (TFieldIterator<FProperty> it(InGenerator->GetClass()); it; ++it)
+    {
+        FString value;
+        it->ExportTextItem_InContainer(value, InGenerator, nullptr, nullptr, PPF_None);
+        hash = HashCombine(hash, GetTypeHash(value));
+    }
+
+    return hash;
+}
@@ -49,6 +49,50 @@ namespace VoxelNoise
 
         return noise;
     }
+
+    static double ComputeNoise2D(
+        const FVector2D& InLocation,
+        EVoxelNoiseType InNoiseType,
+        double InAmplitude = 1.0,
+        double InFrequency = 1.0,
+        int InOctaves = 1
+    )
+    {
+        double noise = 0.0;
+        double persistence = 0.5;
+        double lacunarity = 2.0;
+
+        for (int i = 0; i < InOctaves; i++)
+        {
+            switch (InNoiseType)
+            {
+            case EVoxelNoiseType::VN_Perlin:
+                noise += ((FMath::PerlinNoise2D(InLocation * InFrequency) + 1.0) / 2.0) * InAmplitude;
+                break;
+
+            default:
+                break;
+            };
+
+            InAmplitude *= persistence;
+            InFrequency *= lacunarity;
+        }
+
+        return noise;
+    }
+
+    // Highest value ComputeNoise2D/3D can return, every octave at its peak
+    static double GetMaxNoise(double InAmplitude, int InOctaves)
+    {
+        double maxNoise = 0.0;
+        for (int i = 0; i < InOctaves; i++)
+        {
+            maxNoise += InAmplitude;
+            InAmplitude *= 0.5;
+        }
+
+        return maxNoise;
+    }
 }
 
 USTRUCT(BlueprintType)
@@ -56,6 +100,7 @@ struct FBiomeMaterialData
 {
     GENERATED_BODY()
 public:
+    // Minimum cell density (average of its corners) for this material to be used, highest matching isovalue wins
     UPROPERTY(BlueprintReadOnly, EditDefaultsOnly)
     double Isovalue;
 
@@ -71,6 +116,10 @@ class VOXEL_API UVoxelProcGen_ValueGenerator : public UObject
 public:
 
     virtual float GenerateValue(const FVector& InLocation, const double InVolumeExtent, const FVector& InCenter = FVector::ZeroVector, double Seed = 0.0) const { return 0.f; };
+
+    // Most the value can have changed within InRegion since InPrevious (a copy of this generator from before an edit),
+    // so only chunks the edit could affect are regenerated. False when it can't be bounded
+    virtual bool GetMaxChange(const UVoxelProcGen_ValueGenerator* InPrevious, const FBox& InRegion, const double InVolumeExtent, double& OutMaxChange) const { return false; };
 };
 
 UCLASS()
@@ -87,6 +136,17 @@ public:
         double desiredRadius = InVolumeExtent * RadiusNormalized;
         return SignedDistanceField::GetDistanceSphere(InCenter.IsZero() ? InLocation : InLocation - InCenter, desiredRadius);
     }
+
+    // Distance over radius, so a new radius changes the value in proportion to the distance from the center
+    virtual bool GetMaxChange(const UVoxelProcGen_ValueGenerator* InPrevious, const FBox& InRegion, const double InVolumeExtent, double& OutMaxChange) const override
+    {
+        const UVoxelProcGen_SdfSphere* previous = Cast<UVoxelProcGen_SdfSphere>(InPrevious);
+        if (!previous || FMath::IsNearlyZero(RadiusNormalized) || FMath::IsNearlyZero(previous->RadiusNormalized)) return false;
+
+        const double farthestDistance = FVector::Max(InRegion.Min.GetAbs(), InRegion.Max.GetAbs()).Length();
+        OutMaxChange = farthestDistance * FMath::Abs(1.0 / (InVolumeExtent * RadiusNormalized) - 1.0 / (InVolumeExtent * previous->RadiusNormalized));
+        return true;
+    }
 };
 
 UCLASS()
@@ -113,6 +173,97 @@ public:
         FVector locationRelative = InCenter.IsZero() ? InLocation : InLocation - InCenter;
         return VoxelNoise::ComputeNoise3D(locationRelative, Type, Amplitude, Frequency, Octaves);
     }
+
+    // Both values are somewhere between 0 and their summed octave amplitudes
+    virtual bool GetMaxChange(const UVoxelProcGen_ValueGenerator* InPrevious, const FBox& InRegion, const double InVolumeExtent, double& OutMaxChange) const override
+    {
+        const UVoxelProcGen_Noise* previous = Cast<UVoxelProcGen_Noise>(InPrevious);
+        if (!previous) return false;
+
+        const double peak = VoxelNoise::GetMaxNoise(Amplitude, Octaves);
+        const double previousPeak = VoxelNoise::GetMaxNoise(previous->Amplitude, previous->Octaves);
+        OutMaxChange = FMath::Max3(0.0, peak, previousPeak) - FMath::Min3(0.0, peak, previousPeak);
+        return true;
+    }
+};
+
+// Evaluated once per (x, y) column of a chunk, then combined with each corner of that column
+UCLASS(DefaultToInstanced, EditInlineNew, Abstract)
+class VOXEL_API UVoxelProcGen_ColumnGenerator : public UObject
+{
+    GENERATED_BODY()
+
+public:
+
+    // Expensive part, only depends on X/Y (ex. terrain height)
+    virtual float GenerateColumnValue(const FVector2D& InLocation, const double InVolumeExtent, const FVector& InCenter = FVector::ZeroVector, double Seed = 0.0) const { return 0.f; };
+
+    // Cheap part, turns the cached column value into a density for a corner of that column
+    virtual float CombineColumnValue(float InColumnValue, const FVector& InLocation, const double InVolumeExtent, const FVector& InCenter = FVector::ZeroVector, double Seed = 0.0) const { return InColumnValue; };
+
+    // See UVoxelProcGen_ValueGenerator::GetMaxChange
+    virtual bool GetMaxChange(const UVoxelProcGen_ColumnGenerator* InPrevious, const FBox& InRegion, const double InVolumeExtent, double& OutMaxChange) const { return false; };
+};
+
+UCLASS()
+class UVoxelProcGen_Heightfield : public UVoxelProcGen_ColumnGenerator
+{
+    GENERATED_BODY()
+
+public:
+    UPROPERTY(EditDefaultsOnly)
+    TEnumAsByte<EVoxelNoiseType> Type = EVoxelNoiseType::VN_Perlin;
+
+    // Height of the flat surface, relative to the volume extent
+    UPROPERTY(EditDefaultsOnly)
+    double BaseHeightNormalized = 0.0;
+
+    // Height of the noise, relative to the volume extent
+    UPROPERTY(EditDefaultsOnly)
+    double AmplitudeNormalized = 0.1;
+
+    UPROPERTY(EditDefaultsOnly)
+    double Frequency = 0.00005;
+
+    UPROPERTY(EditDefaultsOnly)
+    int Octaves = 1;
+
+    // Distance from the surface, relative to the volume extent, over which the density changes by 1
+    UPROPERTY(EditDefaultsOnly, Meta = (ClampMin = "0.0001"))
+    double FalloffNormalized = 0.01;
+
+    // Density at the surface, should match the volume's ActiveDensityThreshold when used alone
+    UPROPERTY(EditDefaultsOnly)
+    double SurfaceDensity = 1.0;
+
+    virtual float GenerateColumnValue(const FVector2D& InLocation, const double InVolumeExtent, const FVector& InCenter = FVector::ZeroVector, double Seed = 0.0) const override
+    {
+        const FVector2D locationRelative = InCenter.IsZero() ? InLocation : InLocation - FVector2D(InCenter);
+        const double noise = VoxelNoise::ComputeNoise2D(locationRelative, Type, 1.0, Frequency, Octaves);
+        return (BaseHeightNormalized + noise * AmplitudeNormalized) * InVolumeExtent;
+    }
+
+    virtual float CombineColumnValue(float InColumnValue, const FVector& InLocation, const double InVolumeExtent, const FVector& InCenter = FVector::ZeroVector, double Seed = 0.0) const override
+    {
+        const double heightAboveSurface = InLocation.Z - InCenter.Z - InColumnValue;
+        return SurfaceDensity + heightAboveSurface / (InVolumeExtent * FalloffNormalized);
+    }
+
+    // With the same falloff the density moves by the height difference, and the height stays within its noise range
+    virtual bool GetMaxChange(const UVoxelProcGen_ColumnGenerator* InPrevious, const FBox& InRegion, const double InVolumeExtent, double& OutMaxChange) const override
+    {
+        const UVoxelProcGen_Heightfield* previous = Cast<UVoxelProcGen_Heightfield>(InPrevious);
+        if (!previous || FalloffNormalized != previous->FalloffNormalized) return false;
+
+        const double peak = VoxelNoise::GetMaxNoise(AmplitudeNormalized, Octaves);
+        const double previousPeak = VoxelNoise::GetMaxNoise(previous->AmplitudeNormalized, previous->Octaves);
+
+        const double maxHeight = FMath::Max(BaseHeightNormalized + FMath::Max(0.0, peak), previous->BaseHeightNormalized + FMath::Max(0.0, previousPeak));
+        const double minHeight = FMath::Min(BaseHeightNormalized + FMath::Min(0.0, peak), previous->BaseHeightNormalized + FMath::Min(0.0, previousPeak));
+
+        OutMaxChange = (maxHeight - minHeight) / FalloffNormalized + FMath::Abs(SurfaceDensity - previous->SurfaceDensity);
+        return true;
+    }
 };
 
 /**
@@ -137,14 +288,82 @@ public:
             value += gen->GenerateValue(InLocation, InVolumeExtent, InCenter, Seed);
         }
 
+        for (const TObjectPtr<UVoxelProcGen_ColumnGenerator>& gen : ColumnGenerators)
+        {
+            const float columnValue = gen->GenerateColumnValue(FVector2D(InLocation), InVolumeExtent, InCenter, Seed);
+            value += gen->CombineColumnValue(columnValue, InLocation, InVolumeExtent, InCenter, Seed);
+        }
+
         return value;
     }
+
+    // Same as above, but with the column values of InLocation's (x, y) already cached by GenerateColumnValues
+    double GenerateProceduralValue(const FVector& InLocation, const double* InColumnValues, const double InVolumeExtent, const FVector& InCenter = FVector::ZeroVector, double Seed = 0.0)
+    {
+        double value = 0.0;
+        for (const TObjectPtr<UVoxelProcGen_ValueGenerator>& gen : ValueGenerators)
+        {
+            value += gen->GenerateValue(InLocation, InVolumeExtent, InCenter, Seed);
+        }
+
+        for (int i = 0; i < ColumnGenerators.Num(); i++)
+        {
+            value += ColumnGenerators[i]->CombineColumnValue(InColumnValues[i], InLocation, InVolumeExtent, InCenter, Seed);
+        }
+
+        return value;
+    }
+
+    // Fills OutColumnValues with one value per column generator, must hold GetNumColumnGenerators() elements
+    void GenerateColumnValues(const FVector2D& InLocation, double* OutColumnValues, const double InVolumeExtent, const FVector& InCenter = FVector::ZeroVector, double Seed = 0.0)
+    {
+        for (int i = 0; i < ColumnGenerators.Num(); i++)
+        {
+            OutColumnValues[i] = ColumnGenerators[i]->GenerateColumnValue(InLocation, InVolumeExtent, InCenter, Seed);
+        }
+    }
+
+    const int GetNumColumnGenerators() const { return ColumnGenerators.Num(); };
+
+    // Hash of a generator's settings, to tell which generators of the stack an edit changed
+    static uint32 HashSettings(const UObject* InGenerator);
+
+    // Material slot of a cell from the density samples of its corners, cheap enough to call per cell while meshing
+    const int GetMaterialIndex(const double* InCornerDensities, int InNumMaterials) const
+    {
+        if (InNumMaterials <= 1 || BiomeMaterialData.IsEmpty()) return 0;
+
+        double density = 0.0;
+        for (int i = 0; i < 8; i++)
+        {
+            density += InCornerDensities[i];
+        }
+        density /= 8.0;
+
+        int materialIndex = 0;
+        double bestIsovalue = -DBL_MAX;
+        for (int i = 0; i < BiomeMaterialData.Num() && i < InNumMaterials; i++)
+        {
+            const double isovalue = BiomeMaterialData[i].Isovalue;
+            if (isovalue <= density && isovalue > bestIsovalue)
+            {
+                bestIsovalue = isovalue;
+                materialIndex = i;
+            }
+        }
+
+        return materialIndex;
+    }
     
     // Additive calculations of density per location
     UPROPERTY(EditDefaultsOnly, BlueprintReadOnly, Instanced)
     TArray<TObjectPtr<UVoxelProcGen_ValueGenerator>> ValueGenerators;
 
-    // Todo
+    // Additive calculations of density evaluated once per (x, y) column, for heightmap style terrain
+    UPROPERTY(EditDefaultsOnly, BlueprintReadOnly, Instanced)
+    TArray<TObjectPtr<UVoxelProcGen_ColumnGenerator>> ColumnGenerators;
+
+    // Materials per density range, index matches the volume's material slot and section polygroup
     UPROPERTY(BlueprintReadOnly, EditDefaultsOnly)
     TArray<FBiomeMaterialData> BiomeMaterialData;
 };
\ No newline at end of file
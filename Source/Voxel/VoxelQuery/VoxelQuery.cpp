@@ -0,0 +1,249 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "VoxelQuery.h"
+
+#include "VoxelVolume.h"
+#include "VoxelChunk/VoxelChunkNode.h"
+#include "VoxelChunk/VoxelDirtyChunkData.h"
+#include "VoxelProceduralGeneration/VoxelProceduralGenerator.h"
+#include "VoxelUtilities/VoxelDensityPyramid.h"
+
+namespace
+{
+	// Slab test, InDirection doesn't need to be normalized
+	bool IntersectRayBox(const FVector& InOrigin, const FVector& InDirection, const FBox& InBox, double& OutEnter, double& OutExit)
+	{
+		OutEnter = -DBL_MAX;
+		OutExit = DBL_MAX;
+
+		for (int axis = 0; axis < 3; axis++)
+		{
+			if (FMath::IsNearlyZero(InDirection[axis]))
+			{
+				if (InOrigin[axis] < InBox.Min[axis] || InOrigin[axis] > InBox.Max[axis]) return false;
+				continue;
+			}
+
+			double t1 = (InBox.Min[axis] - InOrigin[axis]) / InDirection[axis];
+			double t2 = (InBox.Max[axis] - InOrigin[axis]) / InDirection[axis];
+			if (t1 > t2) Swap(t1, t2);
+
+			OutEnter = FMath::Max(OutEnter, t1);
+			OutExit = FMath::Min(OutExit, t2);
+		}
+
+		return OutEnter <= OutExit;
+	}
+}
+
+FVoxelQuery::FVoxelQuery(AVoxelVolume* InVolume) :
+	Volume(InVolume)
+{
+	check(Volume);
+
+	Generator = Volume->ProceduralGeneratorClass.GetDefaultObject();
+	RootNode = Volume->RootNode;
+	Threshold = Volume->ActiveDensityThreshold;
+	VolumeExtent = Volume->VolumeExtent;
+}
+
+const FVoxelChunkNode* FVoxelQuery::FindLeaf(const FVector& InLocation) const
+{
+	const FVoxelChunkNode* node = RootNode;
+	while (node && !node->IsLeaf())
+	{
+		const uint8 idxChild =
+			(InLocation.X >= node->Location.X ? 4 : 0) |
+			(InLocation.Y >= node->Location.Y ? 2 : 0) |
+			(InLocation.Z >= node->Location.Z ? 1 : 0);
+
+		if (!node->Children[idxChild]) break;
+		node = node->Children[idxChild];
+	}
+
+	return node;
+}
+
+double FVoxelQuery::SampleDensity(const FVector& InLocation)
+{
+	const FVoxelChunkNode* leaf = FindLeaf(InLocation);
+
+	// Interpolate the leaf's retained densities when we have them, same values the mesh was built from
+	if (FVoxelDirtyChunkData* retained = leaf ? Volume->ChunkMemory.FindRetained(const_cast<FVoxelChunkNode*>(leaf)) : nullptr)
+	{
+		const FArray3D<double>& densities = retained->CornerDensityValues;
+		if (densities.IsAllocated())
+		{
+			const int resolution = retained->ChunkResolution;
+			const double chunkExtent = leaf->GetExtent(VolumeExtent);
+			const double voxelSize = chunkExtent * 2 / resolution;
+			const FVector cell = ((InLocation - (leaf->Location - chunkExtent)) / voxelSize).BoundToBox(FVector::ZeroVector, FVector(resolution));
+
+			const int x = FMath::Min(FMath::FloorToInt(cell.X), resolution - 1);
+			const int y = FMath::Min(FMath::FloorToInt(cell.Y), resolution - 1);
+			const int z = FMath::Min(FMath::FloorToInt(cell.Z), resolution - 1);
+			const FVector alpha = cell - FVector(x, y, z);
+
+			auto density = [&densities](int InX, int InY, int InZ) { return densities[densities.GetIndex1D(InX, InY, InZ)]; };
+
+			const double c00 = FMath::Lerp(density(x, y, z), density(x + 1, y, z), alpha.X);
+			const double c01 = FMath::Lerp(density(x, y, z + 1), density(x + 1, y, z + 1), alpha.X);
+			const double c10 = FMath::Lerp(density(x, y + 1, z), density(x + 1, y + 1, z), alpha.X);
+			const double c11 = FMath::Lerp(density(x, y + 1, z + 1), density(x + 1, y + 1, z + 1), alpha.X);
+
+			return FMath::Lerp(FMath::Lerp(c00, c10, alpha.Y), FMath::Lerp(c01, c11, alpha.Y), alpha.Z);
+		}
+	}
+
+	const double density = Generator ? Generator->GenerateProceduralValue(InLocation, VolumeExtent) : Threshold + 1.0;
+	return Volume->EditOps.Apply(InLocation, density, Threshold);
+}
+
+FVector FVoxelQuery::SampleGradient(const FVector& InLocation, double InStep)
+{
+	return FVector(
+		SampleDensity(InLocation + FVector(InStep, 0, 0)) - SampleDensity(InLocation - FVector(InStep, 0, 0)),
+		SampleDensity(InLocation + FVector(0, InStep, 0)) - SampleDensity(InLocation - FVector(0, InStep, 0)),
+		SampleDensity(InLocation + FVector(0, 0, InStep)) - SampleDensity(InLocation - FVector(0, 0, InStep))
+	);
+}
+
+bool FVoxelQuery::FindEmptyBox(const FVector& InLocation, double InRadius, FBox& OutBox) const
+{
+	const FVoxelChunkNode* leaf = FindLeaf(InLocation);
+	if (!leaf || !leaf->DensityPyramid) return false;
+
+	// Regenerating (an edit or a generator change), the pyramid is of the densities before it
+	if (Volume->DirtyChunkDataMap.Contains(const_cast<FVoxelChunkNode*>(leaf))) return false;
+
+	// The pyramid only bounds what SampleDensity returns when it reads the corners it was built from. Coarser
+	// chunks fall back to the generator, which has detail between their corners
+	if (leaf->Depth < Volume->MaxDepth && !Volume->ChunkMemory.IsRetained(leaf)) return false;
+
+	const FVoxelDensityPyramid& pyramid = *leaf->DensityPyramid;
+	const double chunkExtent = leaf->GetExtent(VolumeExtent);
+	const double voxelSize = chunkExtent * 2 / Volume->GetChunkResolution(leaf->Depth);
+	const FVector chunkMin = leaf->Location - chunkExtent;
+	const FVector cell = (InLocation - chunkMin) / voxelSize;
+
+	// Coarsest empty brick first, it lets us skip the furthest
+	for (int level = pyramid.NumLevels() - 1; level >= 0; level--)
+	{
+		const int brickCells = pyramid.GetBrickCells(level);
+		const int numBricks = pyramid.GetNumBricks(level);
+
+		const int bx = FMath::Clamp(FMath::FloorToInt(cell.X / brickCells), 0, numBricks - 1);
+		const int by = FMath::Clamp(FMath::FloorToInt(cell.Y / brickCells), 0, numBricks - 1);
+		const int bz = FMath::Clamp(FMath::FloorToInt(cell.Z / brickCells), 0, numBricks - 1);
+
+		if (pyramid.GetBrick(level, bx, by, bz).Min <= Threshold) continue;
+
+		const FVector brickMin = chunkMin + FVector(bx, by, bz) * brickCells * voxelSize;
+		const FVector brickMax = (brickMin + FVector(brickCells * voxelSize)).ComponentMin(leaf->Location + chunkExtent);
+
+		OutBox = FBox(brickMin, brickMax).ExpandBy(-InRadius);
+		if (OutBox.IsValid && OutBox.IsInsideOrOn(InLocation)) return true;
+	}
+
+	return false;
+}
+
+bool FVoxelQuery::IsSolid(const FVector& InLocation, double InRadius)
+{
+	if (SampleDensity(InLocation) <= Threshold) return true;
+	if (InRadius <= 0.0) return false;
+
+	static const FVector directions[] =
+	{
+		FVector(1, 0, 0), FVector(-1, 0, 0), FVector(0, 1, 0), FVector(0, -1, 0), FVector(0, 0, 1), FVector(0, 0, -1),
+		FVector(1, 1, 1).GetUnsafeNormal(), FVector(1, 1, -1).GetUnsafeNormal(), FVector(1, -1, 1).GetUnsafeNormal(), FVector(1, -1, -1).GetUnsafeNormal(),
+		FVector(-1, 1, 1).GetUnsafeNormal(), FVector(-1, 1, -1).GetUnsafeNormal(), FVector(-1, -1, 1).GetUnsafeNormal(), FVector(-1, -1, -1).GetUnsafeNormal()
+	};
+
+	for (const FVector& direction : directions)
+	{
+		if (SampleDensity(InLocation + direction * InRadius) <= Threshold) return true;
+	}
+
+	return false;
+}
+
+bool FVoxelQuery::Sweep(const FVector& InStart, const FVector& InEnd, double InRadius, FVector& OutLocation, FVector& OutNormal, double& OutDistance)
+{
+	if (!RootNode) return false;
+
+	FVector direction = InEnd - InStart;
+	const double length = direction.Size();
+	if (length <= UE_DOUBLE_SMALL_NUMBER) return false;
+	direction /= length;
+
+	// Only march the part of the segment inside the volume
+	double tEnter, tExit;
+	if (!IntersectRayBox(InStart, direction, RootNode->GetBox(VolumeExtent).ExpandBy(InRadius), tEnter, tExit)) return false;
+
+	tEnter = FMath::Max(tEnter, 0.0);
+	tExit = FMath::Min(tExit, length);
+	if (tEnter > tExit) return false;
+
+	double tPrevious = tEnter;
+	double t = tEnter;
+	bool bHit = false;
+
+	while (t <= tExit)
+	{
+		const FVector location = InStart + direction * t;
+
+		// Skip straight through space the pyramids prove empty
+		FBox emptyBox;
+		if (FindEmptyBox(location, InRadius, emptyBox))
+		{
+			double boxEnter, boxExit;
+			IntersectRayBox(InStart, direction, emptyBox, boxEnter, boxExit);
+
+			tPrevious = FMath::Max(t, boxExit);
+			t = tPrevious + UE_KINDA_SMALL_NUMBER;
+			continue;
+		}
+
+		if (IsSolid(location, InRadius))
+		{
+			bHit = true;
+			break;
+		}
+
+		// March at the leaf's voxel size, finer than the sphere so it can't tunnel through thin features
+		const FVoxelChunkNode* leaf = FindLeaf(location);
+		double step = leaf ? leaf->GetExtent(VolumeExtent) * 2 / Volume->GetChunkResolution(leaf->Depth) : VolumeExtent;
+		if (InRadius > 0.0) step = FMath::Min(step, InRadius);
+
+		tPrevious = t;
+		t = t < tExit ? FMath::Min(t + step, tExit) : tExit + step;
+	}
+
+	if (!bHit) return false;
+
+	// Narrow down the contact between the last free and the first solid position
+	double tFree = tPrevious;
+	double tSolid = t;
+	if (tFree < tSolid)
+	{
+		for (int i = 0; i < 12; i++)
+		{
+			const double tMid = (tFree + tSolid) * 0.5;
+			if (IsSolid(InStart + direction * tMid, InRadius)) tSolid = tMid;
+			else tFree = tMid;
+		}
+	}
+
+	const FVector center = InStart + direction * tSolid;
+	const FVoxelChunkNode* leaf = FindLeaf(center);
+	const double gradientStep = leaf ? leaf->GetExtent(VolumeExtent) / Volume->GetChunkResolution(leaf->Depth) : 1.0;
+
+	// Density grows going out of the surface
+	OutNormal = SampleGradient(center, gradientStep).GetSafeNormal();
+	if (OutNormal.IsZero()) OutNormal = -direction;
+
+	OutLocation = center - OutNormal * InRadius;
+	OutDistance = tSolid;
+	return true;
+}
@@ -0,0 +1,64 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+#include "VoxelQuery.generated.h"
+
+class AVoxelVolume;
+class UVoxelProceduralGenerator;
+struct FVoxelChunkNode;
+
+USTRUCT(BlueprintType)
+struct FVoxelQueryHit
+{
+	GENERATED_BODY()
+public:
+	UPROPERTY(BlueprintReadOnly)
+	bool bHit = false;
+
+	// World space point on the surface
+	UPROPERTY(BlueprintReadOnly)
+	FVector Location = FVector::ZeroVector;
+
+	// World space surface normal, from the density gradient
+	UPROPERTY(BlueprintReadOnly)
+	FVector Normal = FVector::ZeroVector;
+
+	// World space distance travelled from the start
+	UPROPERTY(BlueprintReadOnly)
+	double Distance = 0.0;
+};
+
+// Answers density, ray and sphere sweep queries straight from the octree, retained densities and the generator,
+// without needing collision. Works in the volume's local space, skips space the chunks' density pyramids prove empty
+// where the samples are the densities the pyramid was built from (retained or at max depth).
+struct FVoxelQuery
+{
+	FVoxelQuery(AVoxelVolume* InVolume);
+
+	double SampleDensity(const FVector& InLocation);
+	FVector SampleGradient(const FVector& InLocation, double InStep);
+
+	// Sweeps a sphere of InRadius from InStart to InEnd, a ray when InRadius is 0
+	bool Sweep(const FVector& InStart, const FVector& InEnd, double InRadius, FVector& OutLocation, FVector& OutNormal, double& OutDistance);
+
+	// Deepest node of the octree containing InLocation
+	const FVoxelChunkNode* FindLeaf(const FVector& InLocation) const;
+
+protected:
+
+	// Largest pyramid brick around InLocation known to hold no surface, shrunk by InRadius so a sphere inside it is clear too
+	bool FindEmptyBox(const FVector& InLocation, double InRadius, FBox& OutBox) const;
+
+	// Whether a sphere (or point) at InLocation touches solid density, tested on its center and surface
+	bool IsSolid(const FVector& InLocation, double InRadius);
+
+	AVoxelVolume* Volume = nullptr;
+	UVoxelProceduralGenerator* Generator = nullptr;
+	const FVoxelChunkNode* RootNode = nullptr;
+
+	double Threshold = 1.0;
+	double VolumeExtent = 1.0;
+};
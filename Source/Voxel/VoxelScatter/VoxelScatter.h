@@ -0,0 +1,98 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Math/RandomStream.h"
+
+#include "VoxelScatter.generated.h"
+
+class UStaticMesh;
+
+// Instanced on the scatter points it accepts, layers are tried in order and the first match takes the point
+USTRUCT(BlueprintType)
+struct FVoxelScatterLayer
+{
+	GENERATED_BODY()
+public:
+	UPROPERTY(BlueprintReadWrite, EditAnywhere)
+	TObjectPtr<UStaticMesh> Mesh = nullptr;
+
+	// Biome (material index) the layer grows on, -1 for any
+	UPROPERTY(BlueprintReadWrite, EditAnywhere, Meta = (ClampMin = "-1"))
+	int32 Biome = -1;
+
+	// Steepest surface the layer grows on, in degrees from up
+	UPROPERTY(BlueprintReadWrite, EditAnywhere, Meta = (ClampMin = "0", ClampMax = "180"))
+	float MaxSlope = 35.f;
+
+	// Share of the matching points taken, the rest are left to the next layers
+	UPROPERTY(BlueprintReadWrite, EditAnywhere, Meta = (ClampMin = "0", ClampMax = "1"))
+	float Probability = 1.f;
+
+	UPROPERTY(BlueprintReadWrite, EditAnywhere)
+	FFloatInterval ScaleRange = FFloatInterval(0.8f, 1.2f);
+
+	// Tilt instances with the surface instead of keeping them upright
+	UPROPERTY(BlueprintReadWrite, EditAnywhere)
+	bool bAlignToNormal = false;
+};
+
+// Point on a chunk's surface, in the volume's space
+struct FVoxelScatterPoint
+{
+	FVector3f Position = FVector3f::ZeroVector;
+	FVector3f Normal = FVector3f::UnitZ();
+	uint8 Biome = 0;
+
+	// Per point variation (layer roll, yaw, scale), the same every time the chunk is meshed
+	uint32 Seed = 0;
+};
+
+namespace VoxelScatter
+{
+	// Same for a cell of the same size at the same place, whichever chunk meshes it
+	inline uint32 GetCellSeed(const FVector& InChunkMin, double InVoxelSize, int InX, int InY, int InZ)
+	{
+		const FIntVector cell(
+			FMath::RoundToInt(InChunkMin.X / InVoxelSize) + InX,
+			FMath::RoundToInt(InChunkMin.Y / InVoxelSize) + InY,
+			FMath::RoundToInt(InChunkMin.Z / InVoxelSize) + InZ
+		);
+
+		return HashCombineFast(GetTypeHash(cell), GetTypeHash((float)InVoxelSize));
+	}
+
+	// Points on the triangle (A, B, C), one per InSpacing² of surface on average. The normal follows the mesher's
+	// winding, Cross(C - A, B - A)
+	inline void ScatterTriangle(const FVector3f& A, const FVector3f& B, const FVector3f& C, uint8 InBiome, uint32 InSeed, float InSpacing, TArray<FVoxelScatterPoint>& OutPoints)
+	{
+		FVector3f normal = FVector3f::CrossProduct(C - A, B - A);
+		const float doubleArea = normal.Size();
+		if (doubleArea <= UE_SMALL_NUMBER) return;
+		normal /= doubleArea;
+
+		// Whole points plus a roll for the remaining fraction
+		FRandomStream random((int32)InSeed);
+		const float expectedPoints = 0.5f * doubleArea / FMath::Square(InSpacing);
+		int numPoints = FMath::FloorToInt(expectedPoints);
+		numPoints += random.GetFraction() < expectedPoints - numPoints;
+
+		for (int i = 0; i < numPoints; i++)
+		{
+			float u = random.GetFraction();
+			float v = random.GetFraction();
+			if (u + v > 1.f)
+			{
+				u = 1.f - u;
+				v = 1.f - v;
+			}
+
+			FVoxelScatterPoint& point = OutPoints.AddDefaulted_GetRef();
+			point.Position = A + (B - A) * u + (C - A) * v;
+			point.Normal = normal;
+			point.Biome = InBiome;
+			point.Seed = random.GetUnsignedInt();
+		}
+	}
+}
@@ -0,0 +1,193 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "VoxelSubsystem.h"
+
+#include "VoxelVolume.h"
+#include "VoxelChunk/VoxelDirtyChunkData.h"
+
+void UVoxelSubsystem::Deinitialize()
+{
+	// Volumes release their chunk data, and with it every queued generation, when they end play
+	QueuedGenerations.Empty();
+	QueueHeap.Empty();
+	GenerationsInFlight.Empty();
+	Volumes.Empty();
+
+	Super::Deinitialize();
+}
+
+TStatId UVoxelSubsystem::GetStatId() const
+{
+	RETURN_QUICK_DECLARE_CYCLE_STAT(UVoxelSubsystem, STATGROUP_Tickables);
+}
+
+void UVoxelSubsystem::RegisterVolume(AVoxelVolume* InVolume)
+{
+	Volumes.AddUnique(InVolume);
+}
+
+void UVoxelSubsystem::UnregisterVolume(AVoxelVolume* InVolume)
+{
+	Volumes.Remove(InVolume);
+
+	// Their heap entries are skipped once popped
+	for (auto it = QueuedGenerations.CreateIterator(); it; ++it)
+	{
+		if (it.Value().Volume == InVolume) it.RemoveCurrent();
+	}
+
+	for (auto it = GenerationsInFlight.CreateIterator(); it; ++it)
+	{
+		if (it.Value() == InVolume) it.RemoveCurrent();
+	}
+}
+
+void UVoxelSubsystem::Tick(float DeltaTime)
+{
+	Volumes.RemoveAll([](const TWeakObjectPtr<AVoxelVolume>& InVolume) { return !InVolume.IsValid(); });
+
+	// LOD updates in one pass, round robin so every volume gets its turn when the budget is tight
+	const double startTime = FPlatformTime::Seconds();
+	const double budgetSeconds = FrameBudgetMs / 1000.0;
+
+	for (int32 numUpdated = 0; numUpdated < Volumes.Num(); numUpdated++)
+	{
+		NextVolumeIndex %= Volumes.Num();
+		Volumes[NextVolumeIndex++]->UpdateVolume();
+
+		if (FPlatformTime::Seconds() - startTime > budgetSeconds) break;
+	}
+
+	DispatchGenerations();
+	EnforceMemoryBudget();
+}
+
+void UVoxelSubsystem::QueueGeneration(AVoxelVolume* InVolume, FVoxelDirtyChunkData* InChunkData, float InImportance, EQueuedWorkPriority InPriority)
+{
+	InChunkData->bGenerationQueued = true;
+
+	FQueuedGeneration& generation = QueuedGenerations.Add(InChunkData, { InVolume, InChunkData, InImportance, InPriority });
+	PushHeapEntry(generation);
+}
+
+void UVoxelSubsystem::UpdateImportance(FVoxelDirtyChunkData* InChunkData, float InImportance, EQueuedWorkPriority InPriority)
+{
+	FQueuedGeneration* generation = QueuedGenerations.Find(InChunkData);
+	if (!generation) return;
+
+	generation->Priority = InPriority;
+	if (generation->Importance == InImportance) return;
+
+	generation->Importance = InImportance;
+	PushHeapEntry(*generation);
+}
+
+void UVoxelSubsystem::StartGenerationNow(FVoxelDirtyChunkData* InChunkData)
+{
+	FQueuedGeneration generation;
+	if (!QueuedGenerations.RemoveAndCopyValue(InChunkData, generation)) return;
+
+	StartGeneration(generation);
+}
+
+void UVoxelSubsystem::RemoveGeneration(FVoxelDirtyChunkData* InChunkData)
+{
+	if (InChunkData->bGenerationQueued)
+	{
+		QueuedGenerations.Remove(InChunkData);
+		InChunkData->bGenerationQueued = false;
+	}
+
+	GenerationsInFlight.Remove(InChunkData);
+}
+
+void UVoxelSubsystem::PushHeapEntry(FQueuedGeneration& InGeneration)
+{
+	InGeneration.Serial = NextSerial++;
+	QueueHeap.HeapPush({ InGeneration.ChunkData, InGeneration.Importance, InGeneration.Serial });
+
+	// Stale entries pile up when importances change every update, rebuilt from the live ones once they outnumber them
+	if (QueueHeap.Num() > 2 * QueuedGenerations.Num() + 64)
+	{
+		CompactHeap();
+	}
+}
+
+void UVoxelSubsystem::CompactHeap()
+{
+	QueueHeap.Reset();
+	for (const TPair<FVoxelDirtyChunkData*, FQueuedGeneration>& pair : QueuedGenerations)
+	{
+		QueueHeap.Add({ pair.Key, pair.Value.Importance, pair.Value.Serial });
+	}
+
+	QueueHeap.Heapify();
+}
+
+void UVoxelSubsystem::StartGeneration(const FQueuedGeneration& InGeneration)
+{
+	InGeneration.ChunkData->bGenerationQueued = false;
+	InGeneration.Volume->GenerationPipeline.Start(InGeneration.ChunkData, InGeneration.Priority);
+
+	GenerationsInFlight.Add(InGeneration.ChunkData, InGeneration.Volume);
+}
+
+void UVoxelSubsystem::DispatchGenerations()
+{
+	// Bounded by MaxConcurrentGenerations
+	for (auto it = GenerationsInFlight.CreateIterator(); it; ++it)
+	{
+		if (it.Value()->GenerationPipeline.IsDone(it.Key())) it.RemoveCurrent();
+	}
+
+	int32 numToStart = FMath::Min(MaxConcurrentGenerations - GenerationsInFlight.Num(), QueuedGenerations.Num());
+
+	// Only the ones about to start are popped, the rest of the queue stays a heap
+	while (numToStart > 0 && QueueHeap.Num() > 0)
+	{
+		FHeapEntry entry;
+		QueueHeap.HeapPop(entry, false);
+
+		const FQueuedGeneration* queued = QueuedGenerations.Find(entry.ChunkData);
+		if (!queued || queued->Serial != entry.Serial) continue;
+
+		const FQueuedGeneration generation = *queued;
+		QueuedGenerations.Remove(entry.ChunkData);
+
+		StartGeneration(generation);
+		numToStart--;
+	}
+}
+
+void UVoxelSubsystem::EnforceMemoryBudget()
+{
+	if (MemoryBudgetMB <= 0) return;
+
+	const int64 budgetBytes = (int64)MemoryBudgetMB * 1024 * 1024;
+
+	// Only what eviction can free counts, nodes and generations in flight would otherwise drain every volume each tick
+	int64 evictableBytes = 0;
+	for (const TWeakObjectPtr<AVoxelVolume>& volume : Volumes)
+	{
+		evictableBytes += volume->GetEvictableMemoryBytes();
+	}
+
+	// Evicted from each volume in turn, so one volume doesn't lose everything it kept. Prefetches still generating are skipped
+	bool bEvictedAny = true;
+	while (evictableBytes > budgetBytes && bEvictedAny)
+	{
+		bEvictedAny = false;
+		for (const TWeakObjectPtr<AVoxelVolume>& volume : Volumes)
+		{
+			const int64 freedBytes = volume->ReleaseLeastRecentlyUsed();
+			if (freedBytes)
+			{
+				evictableBytes -= freedBytes;
+				bEvictedAny = true;
+			}
+
+			if (evictableBytes <= budgetBytes) break;
+		}
+	}
+}
@@ -0,0 +1,100 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/WorldSubsystem.h"
+
+#include "VoxelSubsystem.generated.h"
+
+class AVoxelVolume;
+struct FVoxelDirtyChunkData;
+
+// Schedules every voxel volume of a world together: one generation queue ordered by importance across volumes,
+// LOD updates ticked in one pass within a frame budget, and a memory budget over all of them.
+// The budgets are read from [/Script/Voxel.VoxelSubsystem] in DefaultGame.ini
+UCLASS(config = Game)
+class VOXEL_API UVoxelSubsystem : public UTickableWorldSubsystem
+{
+	GENERATED_BODY()
+
+public:
+
+	virtual void Deinitialize() override;
+	virtual void Tick(float DeltaTime) override;
+	virtual TStatId GetStatId() const override;
+
+	void RegisterVolume(AVoxelVolume* InVolume);
+	void UnregisterVolume(AVoxelVolume* InVolume);
+
+	// Started by a later tick, most important first, InImportance is compared across volumes
+	void QueueGeneration(AVoxelVolume* InVolume, FVoxelDirtyChunkData* InChunkData, float InImportance, EQueuedWorkPriority InPriority);
+	void UpdateImportance(FVoxelDirtyChunkData* InChunkData, float InImportance, EQueuedWorkPriority InPriority);
+
+	// Starts a queued generation right away, for synchronous updates
+	void StartGenerationNow(FVoxelDirtyChunkData* InChunkData);
+
+	// Forgets the chunk data, queued or in flight, before it's released
+	void RemoveGeneration(FVoxelDirtyChunkData* InChunkData);
+
+	// Generations running at once over every volume
+	UPROPERTY(Config, BlueprintReadWrite, Category = "Voxel")
+	int MaxConcurrentGenerations = 32;
+
+	// Game thread time per frame for the volumes' LOD updates, the rest continue next frame (at least one volume updates)
+	UPROPERTY(Config, BlueprintReadWrite, Category = "Voxel")
+	float FrameBudgetMs = 4.f;
+
+	// Memory all volumes' evictable chunk data (retained and finished prefetches) should stay under, on top of each
+	// volume's own budget (0 for no limit)
+	UPROPERTY(Config, BlueprintReadWrite, Category = "Voxel")
+	int MemoryBudgetMB = 2048;
+
+	UFUNCTION(BlueprintCallable, Category = "Voxel")
+	int GetNumQueuedGenerations() const { return QueuedGenerations.Num(); };
+
+	UFUNCTION(BlueprintCallable, Category = "Voxel")
+	int GetNumGenerationsInFlight() const { return GenerationsInFlight.Num(); };
+
+protected:
+
+	struct FQueuedGeneration
+	{
+		AVoxelVolume* Volume = nullptr;
+		FVoxelDirtyChunkData* ChunkData = nullptr;
+		float Importance = 0.f;
+		EQueuedWorkPriority Priority = EQueuedWorkPriority::Normal;
+		// Matches the heap entry that is current for this generation
+		uint64 Serial = 0;
+	};
+
+	// Entries are never removed or updated in place, an entry whose serial no longer matches its queued generation is stale
+	// and skipped when popped
+	struct FHeapEntry
+	{
+		FVoxelDirtyChunkData* ChunkData = nullptr;
+		float Importance = 0.f;
+		uint64 Serial = 0;
+
+		bool operator<(const FHeapEntry& Other) const { return Importance > Other.Importance; }
+	};
+
+	void PushHeapEntry(FQueuedGeneration& InGeneration);
+	void CompactHeap();
+
+	void StartGeneration(const FQueuedGeneration& InGeneration);
+	void DispatchGenerations();
+	void EnforceMemoryBudget();
+
+	TArray<TWeakObjectPtr<AVoxelVolume>> Volumes;
+
+	// Next volume to update, updates resume from here when the previous frame ran out of budget
+	int32 NextVolumeIndex = 0;
+
+	TMap<FVoxelDirtyChunkData*, FQueuedGeneration> QueuedGenerations;
+	// Most important queued generation on top
+	TArray<FHeapEntry> QueueHeap;
+	uint64 NextSerial = 0;
+
+	TMap<FVoxelDirtyChunkData*, AVoxelVolume*> GenerationsInFlight;
+};
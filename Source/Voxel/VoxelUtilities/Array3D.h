@@ -1,51 +1,77 @@
-
-
 #pragma once
 
 #include "CoreMinimal.h"
 
 
+// How FArray3D orders its elements in memory
+enum class EArray3DLayout : uint8
+{
+	// x-major, z contiguous
+	Linear,
+	// Linear, with rows padded to whole cache lines so each (x, y) row starts aligned
+	LinearPadded
+};
+
 template<typename InElementType>
 struct FArray3D
 {
-	TArray<InElementType> InternalArray;
-	FIntVector Size3D;
-	int32 SizeTotal;
+	static constexpr uint32 Alignment = 64;
+	static constexpr int32 ElementsPerCacheLine = FMath::Max<int32>(1, Alignment / sizeof(InElementType));
+
+	TArray<InElementType, TAlignedHeapAllocator<Alignment>> InternalArray;
+	FIntVector Size3D = FIntVector::ZeroValue;
+	int32 SizeTotal = 0;
+
+	EArray3DLayout Layout = EArray3DLayout::Linear;
+
+	// Elements between consecutive rows (y) and slabs (x)
+	int32 RowStride = 0;
+	int32 SlabStride = 0;
 
 	FArray3D() {};
 
+	FArray3D(const FArray3D&) = default;
+	FArray3D(FArray3D&&) = default;
+	FArray3D& operator=(const FArray3D&) = default;
+	FArray3D& operator=(FArray3D&&) = default;
+
 	~FArray3D()
 	{
 		InternalArray.Empty();
 	};
 
-	void Init(int32 InSizeX, int32 InSizeY, int32 InSizeZ, const InElementType& InitValue = InElementType())
+	void Init(int32 InSizeX, int32 InSizeY, int32 InSizeZ, const InElementType& InitValue = InElementType(), EArray3DLayout InLayout = EArray3DLayout::Linear)
 	{
-		Size3D = FIntVector(InSizeX, InSizeY, InSizeZ);
-		SizeTotal = Size3D.X * Size3D.Y * Size3D.Z;
-		InternalArray.Init(InitValue, SizeTotal);
+		Init(FIntVector(InSizeX, InSizeY, InSizeZ), InitValue, InLayout);
 	}
 
-	void Init(const FIntVector& InSize3D, const InElementType& InitValue = InElementType())
+	void Init(const FIntVector& InSize3D, const InElementType& InitValue = InElementType(), EArray3DLayout InLayout = EArray3DLayout::Linear)
 	{
 		Size3D = InSize3D;
 		SizeTotal = Size3D.X * Size3D.Y * Size3D.Z;
-		InternalArray.Init(InitValue, SizeTotal);
+		Layout = InLayout;
+
+		RowStride = Layout == EArray3DLayout::LinearPadded
+			? FMath::DivideAndRoundUp(Size3D.Z, ElementsPerCacheLine) * ElementsPerCacheLine
+			: Size3D.Z;
+		SlabStride = RowStride * Size3D.Y;
+
+		InternalArray.Init(InitValue, GetNumElements());
 	}
 
 	void Reset(const InElementType& InitValue = InElementType())
 	{
-		InternalArray.Init(InitValue, SizeTotal);
+		InternalArray.Init(InitValue, GetNumElements());
 	}
 
-	FArray3D(int32 InSizeX, int32 InSizeY, int32 InSizeZ, const InElementType& InitValue = InElementType())
+	FArray3D(int32 InSizeX, int32 InSizeY, int32 InSizeZ, const InElementType& InitValue = InElementType(), EArray3DLayout InLayout = EArray3DLayout::Linear)
 	{
-		Init(InSizeX, InSizeY, InSizeZ, InitValue);
+		Init(InSizeX, InSizeY, InSizeZ, InitValue, InLayout);
 	}
 
-	FArray3D(const FIntVector& InSize3D, const InElementType& InitValue = InElementType())
+	FArray3D(const FIntVector& InSize3D, const InElementType& InitValue = InElementType(), EArray3DLayout InLayout = EArray3DLayout::Linear)
 	{
-		Init(InSize3D, InitValue);
+		Init(InSize3D, InitValue, InLayout);
 	}
 
 	FORCEINLINE InElementType& operator[](int32 Index)
@@ -68,28 +94,69 @@ struct FArray3D
 		return InternalArray[GetIndex1D(Index3D)];
 	}
 
-	const int32 GetIndex1D(int32 InX, int32 InY, int32 InZ) const
+	FORCEINLINE const int32 GetIndex1D(int32 InX, int32 InY, int32 InZ) const
+	{
+		return InX * SlabStride + InY * RowStride + InZ;
+	}
+
+	FORCEINLINE const int32 GetIndex1D(const FIntVector& InIndex3D) const
 	{
-		return InX * Size3D.Z * Size3D.Y + (InY * Size3D.Z + InZ);
+		return GetIndex1D(InIndex3D.X, InIndex3D.Y, InIndex3D.Z);
 	}
 
-	const int32 GetIndex1D(const FIntVector& InIndex3D) const
+	FIntVector GetIndex3D(int32 InIndex) const
 	{
-		return InIndex3D.X * Size3D.Z * Size3D.Y + (InIndex3D.Y * Size3D.Z + InIndex3D.Z);
+		const int32 x = InIndex / SlabStride;
+		const int32 w = InIndex % SlabStride;
+		return FIntVector(x, w / RowStride, w % RowStride);
 	}
 
-	FIntVector GetIndex3D(int32 InIndex)
+	// 1D distance to the element (InX, InY, InZ) away, the same from any element
+	FORCEINLINE const int32 GetOffset1D(int32 InX, int32 InY, int32 InZ) const
 	{
-		int32 yz = (Size3D.Y * Size3D.Z);
-		int32 x = InIndex / yz;
-		int32 w = InIndex % yz;
-		int32 y = w / Size3D.Z;
-		int32 z = w % Size3D.Z;
+		return InX * SlabStride + InY * RowStride + InZ;
+	}
 
-		return FIntVector(x, y, z);
+	// The GetSizeZ() elements of row (x, y)
+	TArrayView<InElementType> GetRow(int32 InX, int32 InY)
+	{
+		return TArrayView<InElementType>(InternalArray.GetData() + InX * SlabStride + InY * RowStride, Size3D.Z);
 	}
 
+	TArrayView<const InElementType> GetRow(int32 InX, int32 InY) const
+	{
+		return TArrayView<const InElementType>(InternalArray.GetData() + InX * SlabStride + InY * RowStride, Size3D.Z);
+	}
+
+	// Every row of slab x including their padding, step rows with GetRowStride()
+	TArrayView<InElementType> GetSlab(int32 InX)
+	{
+		return TArrayView<InElementType>(InternalArray.GetData() + InX * SlabStride, SlabStride);
+	}
+
+	TArrayView<const InElementType> GetSlab(int32 InX) const
+	{
+		return TArrayView<const InElementType>(InternalArray.GetData() + InX * SlabStride, SlabStride);
+	}
+
+	InElementType* GetData() { return InternalArray.GetData(); };
+	const InElementType* GetData() const { return InternalArray.GetData(); };
+
+	const EArray3DLayout GetLayout() const { return Layout; };
+	const int32 GetRowStride() const { return RowStride; };
+	const int32 GetSlabStride() const { return SlabStride; };
+
+	// Elements the layout needs, SizeTotal plus padding
+	const int32 GetNumElements() const
+	{
+		return Size3D.X * SlabStride;
+	}
+
+	// False once emptied
+	const bool IsAllocated() const { return SizeTotal && InternalArray.Num() == GetNumElements(); };
+
 	const int32 GetSizeTotal() const { return SizeTotal; };
+	const SIZE_T GetAllocatedSize() const { return InternalArray.GetAllocatedSize(); };
 	const int32 GetSizeX() const { return Size3D.X; };
 	const int32 GetSizeY() const { return Size3D.Y; };
 	const int32 GetSizeZ() const { return Size3D.Z; };
@@ -102,4 +169,4 @@ struct FArray3D
 		//SizeTotal = 0;
 		InternalArray.Empty();
 	}
-};
\ No newline at end of file
+};
@@ -0,0 +1,70 @@
+
+
+#include "VoxelDensityPyramid.h"
+
+void FVoxelDensityPyramid::Build(const FArray3D<double>& InDensities, int InResolution)
+{
+	Levels.Reset();
+	LevelSizes.Reset();
+
+	// Level 0, straight from the corners, neighboring bricks share their boundary corners
+	int size = FMath::DivideAndRoundUp(InResolution, BrickSize);
+	TArray<FFloatInterval>& base = Levels.AddDefaulted_GetRef();
+	base.SetNum(size * size * size);
+	LevelSizes.Add(size);
+
+	for (int bx = 0; bx < size; bx++)
+	{
+		for (int by = 0; by < size; by++)
+		{
+			for (int bz = 0; bz < size; bz++)
+			{
+				FFloatInterval& brick = base[(bx * size + by) * size + bz];
+
+				const int maxX = FMath::Min((bx + 1) * BrickSize, InResolution);
+				const int maxY = FMath::Min((by + 1) * BrickSize, InResolution);
+				const int maxZ = FMath::Min((bz + 1) * BrickSize, InResolution);
+
+				for (int x = bx * BrickSize; x <= maxX; x++)
+				{
+					for (int y = by * BrickSize; y <= maxY; y++)
+					{
+						for (int z = bz * BrickSize; z <= maxZ; z++)
+						{
+							brick.Include((float)InDensities[InDensities.GetIndex1D(x, y, z)]);
+						}
+					}
+				}
+			}
+		}
+	}
+
+	// Merge down to a single brick
+	while (size > 1)
+	{
+		const int parentSize = FMath::DivideAndRoundUp(size, 2);
+		const int idxChildLevel = Levels.Num() - 1;
+
+		TArray<FFloatInterval> parentLevel;
+		parentLevel.SetNum(parentSize * parentSize * parentSize);
+
+		for (int bx = 0; bx < size; bx++)
+		{
+			for (int by = 0; by < size; by++)
+			{
+				for (int bz = 0; bz < size; bz++)
+				{
+					const FFloatInterval& child = Levels[idxChildLevel][(bx * size + by) * size + bz];
+					FFloatInterval& parent = parentLevel[((bx / 2) * parentSize + by / 2) * parentSize + bz / 2];
+
+					parent.Include(child.Min);
+					parent.Include(child.Max);
+				}
+			}
+		}
+
+		Levels.Add(MoveTemp(parentLevel));
+		LevelSizes.Add(parentSize);
+		size = parentSize;
+	}
+}
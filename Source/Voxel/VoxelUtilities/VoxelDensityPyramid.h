@@ -0,0 +1,46 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+#include "Array3D.h"
+
+// Min/max of a chunk's corner densities per brick, each level merging 2x2x2 bricks of the previous one.
+// Trilinear interpolation never leaves a brick's range, so a brick with a min above the threshold holds no surface.
+struct FVoxelDensityPyramid
+{
+	// Cells per side of a level 0 brick
+	static constexpr int BrickSize = 4;
+
+	void Build(const FArray3D<double>& InDensities, int InResolution);
+
+	// Cells per side of a brick at InLevel
+	const int GetBrickCells(int InLevel) const { return BrickSize << InLevel; };
+	const int GetNumBricks(int InLevel) const { return LevelSizes[InLevel]; };
+	const int NumLevels() const { return Levels.Num(); };
+
+	const FFloatInterval& GetBrick(int InLevel, int InX, int InY, int InZ) const
+	{
+		const int size = LevelSizes[InLevel];
+		return Levels[InLevel][(InX * size + InY) * size + InZ];
+	}
+
+	const FFloatInterval& GetRoot() const { return Levels.Last()[0]; };
+
+	const SIZE_T GetAllocatedSize() const
+	{
+		SIZE_T size = Levels.GetAllocatedSize() + LevelSizes.GetAllocatedSize();
+		for (const TArray<FFloatInterval>& level : Levels)
+		{
+			size += level.GetAllocatedSize();
+		}
+
+		return size;
+	}
+
+protected:
+
+	TArray<TArray<FFloatInterval>> Levels;
+	TArray<int> LevelSizes;
+};
@@ -0,0 +1 @@
+#include "VoxelMarchingCubes.h"
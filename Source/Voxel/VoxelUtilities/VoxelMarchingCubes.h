@@ -0,0 +1,667 @@
+#pragma once
+
+#include "CoreMinimal.h"
+
+#include "Mesh/RealtimeMeshBuilder.h"
+
+#include "VoxelEdit/VoxelEditOpGrid.h"
+#include "VoxelProceduralGeneration/VoxelProceduralGenerator.h"
+#include "VoxelScatter/VoxelScatter.h"
+#include "VoxelUtilities/Array3D.h"
+#include "VoxelUtilities/VoxelMeshStreams.h"
+
+// Source: https://paulbourke.net/geometry/polygonise/
+// Tables are constexpr and compact so the kernels below can fold them, kernels are specialized per chunk setting
+// and picked once per chunk with SelectKernel, the cell loop doesn't branch on settings.
+
+namespace VoxelMarchingCubes
+{
+	// Position of each cube corner relative to corner 0
+	inline constexpr int8 CornerOffsets[8][3] =
+	{
+		{0, 0, 0}, {1, 0, 0}, {1, 1, 0}, {0, 1, 0},
+		{0, 0, 1}, {1, 0, 1}, {1, 1, 1}, {0, 1, 1}
+	};
+
+	// Corners at both ends of each edge
+	inline constexpr int8 EdgeCorners[12][2] =
+	{
+		{0, 1}, {1, 2}, {2, 3}, {3, 0},
+		{4, 5}, {5, 6}, {6, 7}, {7, 4},
+		{0, 4}, {1, 5}, {2, 6}, {3, 7}
+	};
+
+	// Second corner minus first corner of each edge
+	inline constexpr int8 EdgeDirections[12][3] =
+	{
+		{1, 0, 0}, {0, 1, 0}, {-1, 0, 0}, {0, -1, 0},
+		{1, 0, 0}, {0, 1, 0}, {-1, 0, 0}, {0, -1, 0},
+		{0, 0, 1}, {0, 0, 1}, {0, 0, 1}, {0, 0, 1}
+	};
+
+	// Edges cut by the surface for each of the 256 corner states, bit n set when edge n is
+	inline constexpr uint16 EdgeFlags[256] =
+	{
+		0x000, 0x109, 0x203, 0x30a, 0x406, 0x50f, 0x605, 0x70c, 0x80c, 0x905, 0xa0f, 0xb06, 0xc0a, 0xd03, 0xe09, 0xf00,
+		0x190, 0x099, 0x393, 0x29a, 0x596, 0x49f, 0x795, 0x69c, 0x99c, 0x895, 0xb9f, 0xa96, 0xd9a, 0xc93, 0xf99, 0xe90,
+		0x230, 0x339, 0x033, 0x13a, 0x636, 0x73f, 0x435, 0x53c, 0xa3c, 0xb35, 0x83f, 0x936, 0xe3a, 0xf33, 0xc39, 0xd30,
+		0x3a0, 0x2a9, 0x1a3, 0x0aa, 0x7a6, 0x6af, 0x5a5, 0x4ac, 0xbac, 0xaa5, 0x9af, 0x8a6, 0xfaa, 0xea3, 0xda9, 0xca0,
+		0x460, 0x569, 0x663, 0x76a, 0x066, 0x16f, 0x265, 0x36c, 0xc6c, 0xd65, 0xe6f, 0xf66, 0x86a, 0x963, 0xa69, 0xb60,
+		0x5f0, 0x4f9, 0x7f3, 0x6fa, 0x1f6, 0x0ff, 0x3f5, 0x2fc, 0xdfc, 0xcf5, 0xfff, 0xef6, 0x9fa, 0x8f3, 0xbf9, 0xaf0,
+		0x650, 0x759, 0x453, 0x55a, 0x256, 0x35f, 0x055, 0x15c, 0xe5c, 0xf55, 0xc5f, 0xd56, 0xa5a, 0xb53, 0x859, 0x950,
+		0x7c0, 0x6c9, 0x5c3, 0x4ca, 0x3c6, 0x2cf, 0x1c5, 0x0cc, 0xfcc, 0xec5, 0xdcf, 0xcc6, 0xbca, 0xac3, 0x9c9, 0x8c0,
+		0x8c0, 0x9c9, 0xac3, 0xbca, 0xcc6, 0xdcf, 0xec5, 0xfcc, 0x0cc, 0x1c5, 0x2cf, 0x3c6, 0x4ca, 0x5c3, 0x6c9, 0x7c0,
+		0x950, 0x859, 0xb53, 0xa5a, 0xd56, 0xc5f, 0xf55, 0xe5c, 0x15c, 0x055, 0x35f, 0x256, 0x55a, 0x453, 0x759, 0x650,
+		0xaf0, 0xbf9, 0x8f3, 0x9fa, 0xef6, 0xfff, 0xcf5, 0xdfc, 0x2fc, 0x3f5, 0x0ff, 0x1f6, 0x6fa, 0x7f3, 0x4f9, 0x5f0,
+		0xb60, 0xa69, 0x963, 0x86a, 0xf66, 0xe6f, 0xd65, 0xc6c, 0x36c, 0x265, 0x16f, 0x066, 0x76a, 0x663, 0x569, 0x460,
+		0xca0, 0xda9, 0xea3, 0xfaa, 0x8a6, 0x9af, 0xaa5, 0xbac, 0x4ac, 0x5a5, 0x6af, 0x7a6, 0x0aa, 0x1a3, 0x2a9, 0x3a0,
+		0xd30, 0xc39, 0xf33, 0xe3a, 0x936, 0x83f, 0xb35, 0xa3c, 0x53c, 0x435, 0x73f, 0x636, 0x13a, 0x033, 0x339, 0x230,
+		0xe90, 0xf99, 0xc93, 0xd9a, 0xa96, 0xb9f, 0x895, 0x99c, 0x69c, 0x795, 0x49f, 0x596, 0x29a, 0x393, 0x099, 0x190,
+		0xf00, 0xe09, 0xd03, 0xc0a, 0xb06, 0xa0f, 0x905, 0x80c, 0x70c, 0x605, 0x50f, 0x406, 0x30a, 0x203, 0x109, 0x000,
+	};
+
+	// Triangles for each corner state as edge triples, terminated by -1
+	inline constexpr int8 Triangles[256][16] =
+	{
+		{ -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1 },
+		{  0,  8,  3, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1 },
+		{  0,  1,  9, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1 },
+		{  1,  8,  3,  9,  8,  1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1 },
+		{  1,  2, 10, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1 },
+		{  0,  8,  3,  1,  2, 10, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1 },
+		{  9,  2, 10,  0,  2,  9, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1 },
+		{  2,  8,  3,  2, 10,  8, 10,  9,  8, -1, -1, -1, -1, -1, -1, -1 },
+		{  3, 11,  2, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1 },
+		{  0, 11,  2,  8, 11,  0, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1 },
+		{  1,  9,  0,  2,  3, 11, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1 },
+		{  1, 11,  2,  1,  9, 11,  9,  8, 11, -1, -1, -1, -1, -1, -1, -1 },
+		{  3, 10,  1, 11, 10,  3, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1 },
+		{  0, 10,  1,  0,  8, 10,  8, 11, 10, -1, -1, -1, -1, -1, -1, -1 },
+		{  3,  9,  0,  3, 11,  9, 11, 10,  9, -1, -1, -1, -1, -1, -1, -1 },
+		{  9,  8, 10, 10,  8, 11, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1 },
+		{  4,  7,  8, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1 },
+		{  4,  3,  0,  7,  3,  4, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1 },
+		{  0,  1,  9,  8,  4,  7, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1 },
+		{  4,  1,  9,  4,  7,  1,  7,  3,  1, -1, -1, -1, -1, -1, -1, -1 },
+		{  1,  2, 10,  8,  4,  7, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1 },
+		{  3,  4,  7,  3,  0,  4,  1,  2, 10, -1, -1, -1, -1, -1, -1, -1 },
+		{  9,  2, 10,  9,  0,  2,  8,  4,  7, -1, -1, -1, -1, -1, -1, -1 },
+		{  2, 10,  9,  2,  9,  7,  2,  7,  3,  7,  9,  4, -1, -1, -1, -1 },
+		{  8,  4,  7,  3, 11,  2, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1 },
+		{ 11,  4,  7, 11,  2,  4,  2,  0,  4, -1, -1, -1, -1, -1, -1, -1 },
+		{  9,  0,  1,  8,  4,  7,  2,  3, 11, -1, -1, -1, -1, -1, -1, -1 },
+		{  4,  7, 11,  9,  4, 11,  9, 11,  2,  9,  2,  1, -1, -1, -1, -1 },
+		{  3, 10,  1,  3, 11, 10,  7,  8,  4, -1, -1, -1, -1, -1, -1, -1 },
+		{  1, 11, 10,  1,  4, 11,  1,  0,  4,  7, 11,  4, -1, -1, -1, -1 },
+		{  4,  7,  8,  9,  0, 11,  9, 11, 10, 11,  0,  3, -1, -1, -1, -1 },
+		{  4,  7, 11,  4, 11,  9,  9, 11, 10, -1, -1, -1, -1, -1, -1, -1 },
+		{  9,  5,  4, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1 },
+		{  9,  5,  4,  0,  8,  3, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1 },
+		{  0,  5,  4,  1,  5,  0, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1 },
+		{  8,  5,  4,  8,  3,  5,  3,  1,  5, -1, -1, -1, -1, -1, -1, -1 },
+		{  1,  2, 10,  9,  5,  4, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1 },
+		{  3,  0,  8,  1,  2, 10,  4,  9,  5, -1, -1, -1, -1, -1, -1, -1 },
+		{  5,  2, 10,  5,  4,  2,  4,  0,  2, -1, -1, -1, -1, -1, -1, -1 },
+		{  2, 10,  5,  3,  2,  5,  3,  5,  4,  3,  4,  8, -1, -1, -1, -1 },
+		{  9,  5,  4,  2,  3, 11, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1 },
+		{  0, 11,  2,  0,  8, 11,  4,  9,  5, -1, -1, -1, -1, -1, -1, -1 },
+		{  0,  5,  4,  0,  1,  5,  2,  3, 11, -1, -1, -1, -1, -1, -1, -1 },
+		{  2,  1,  5,  2,  5,  8,  2,  8, 11,  4,  8,  5, -1, -1, -1, -1 },
+		{ 10,  3, 11, 10,  1,  3,  9,  5,  4, -1, -1, -1, -1, -1, -1, -1 },
+		{  4,  9,  5,  0,  8,  1,  8, 10,  1,  8, 11, 10, -1, -1, -1, -1 },
+		{  5,  4,  0,  5,  0, 11,  5, 11, 10, 11,  0,  3, -1, -1, -1, -1 },
+		{  5,  4,  8,  5,  8, 10, 10,  8, 11, -1, -1, -1, -1, -1, -1, -1 },
+		{  9,  7,  8,  5,  7,  9, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1 },
+		{  9,  3,  0,  9,  5,  3,  5,  7,  3, -1, -1, -1, -1, -1, -1, -1 },
+		{  0,  7,  8,  0,  1,  7,  1,  5,  7, -1, -1, -1, -1, -1, -1, -1 },
+		{  1,  5,  3,  3,  5,  7, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1 },
+		{  9,  7,  8,  9,  5,  7, 10,  1,  2, -1, -1, -1, -1, -1, -1, -1 },
+		{ 10,  1,  2,  9,  5,  0,  5,  3,  0,  5,  7,  3, -1, -1, -1, -1 },
+		{  8,  0,  2,  8,  2,  5,  8,  5,  7, 10,  5,  2, -1, -1, -1, -1 },
+		{  2, 10,  5,  2,  5,  3,  3,  5,  7, -1, -1, -1, -1, -1, -1, -1 },
+		{  7,  9,  5,  7,  8,  9,  3, 11,  2, -1, -1, -1, -1, -1, -1, -1 },
+		{  9,  5,  7,  9,  7,  2,  9,  2,  0,  2,  7, 11, -1, -1, -1, -1 },
+		{  2,  3, 11,  0,  1,  8,  1,  7,  8,  1,  5,  7, -1, -1, -1, -1 },
+		{ 11,  2,  1, 11,  1,  7,  7,  1,  5, -1, -1, -1, -1, -1, -1, -1 },
+		{  9,  5,  8,  8,  5,  7, 10,  1,  3, 10,  3, 11, -1, -1, -1, -1 },
+		{  5,  7,  0,  5,  0,  9,  7, 11,  0,  1,  0, 10, 11, 10,  0, -1 },
+		{ 11, 10,  0, 11,  0,  3, 10,  5,  0,  8,  0,  7,  5,  7,  0, -1 },
+		{ 11, 10,  5,  7, 11,  5, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1 },
+		{ 10,  6,  5, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1 },
+		{  0,  8,  3,  5, 10,  6, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1 },
+		{  9,  0,  1,  5, 10,  6, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1 },
+		{  1,  8,  3,  1,  9,  8,  5, 10,  6, -1, -1, -1, -1, -1, -1, -1 },
+		{  1,  6,  5,  2,  6,  1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1 },
+		{  1,  6,  5,  1,  2,  6,  3,  0,  8, -1, -1, -1, -1, -1, -1, -1 },
+		{  9,  6,  5,  9,  0,  6,  0,  2,  6, -1, -1, -1, -1, -1, -1, -1 },
+		{  5,  9,  8,  5,  8,  2,  5,  2,  6,  3,  2,  8, -1, -1, -1, -1 },
+		{  2,  3, 11, 10,  6,  5, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1 },
+		{ 11,  0,  8, 11,  2,  0, 10,  6,  5, -1, -1, -1, -1, -1, -1, -1 },
+		{  0,  1,  9,  2,  3, 11,  5, 10,  6, -1, -1, -1, -1, -1, -1, -1 },
+		{  5, 10,  6,  1,  9,  2,  9, 11,  2,  9,  8, 11, -1, -1, -1, -1 },
+		{  6,  3, 11,  6,  5,  3,  5,  1,  3, -1, -1, -1, -1, -1, -1, -1 },
+		{  0,  8, 11,  0, 11,  5,  0,  5,  1,  5, 11,  6, -1, -1, -1, -1 },
+		{  3, 11,  6,  0,  3,  6,  0,  6,  5,  0,  5,  9, -1, -1, -1, -1 },
+		{  6,  5,  9,  6,  9, 11, 11,  9,  8, -1, -1, -1, -1, -1, -1, -1 },
+		{  5, 10,  6,  4,  7,  8, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1 },
+		{  4,  3,  0,  4,  7,  3,  6,  5, 10, -1, -1, -1, -1, -1, -1, -1 },
+		{  1,  9,  0,  5, 10,  6,  8,  4,  7, -1, -1, -1, -1, -1, -1, -1 },
+		{ 10,  6,  5,  1,  9,  7,  1,  7,  3,  7,  9,  4, -1, -1, -1, -1 },
+		{  6,  1,  2,  6,  5,  1,  4,  7,  8, -1, -1, -1, -1, -1, -1, -1 },
+		{  1,  2,  5,  5,  2,  6,  3,  0,  4,  3,  4,  7, -1, -1, -1, -1 },
+		{  8,  4,  7,  9,  0,  5,  0,  6,  5,  0,  2,  6, -1, -1, -1, -1 },
+		{  7,  3,  9,  7,  9,  4,  3,  2,  9,  5,  9,  6,  2,  6,  9, -1 },
+		{  3, 11,  2,  7,  8,  4, 10,  6,  5, -1, -1, -1, -1, -1, -1, -1 },
+		{  5, 10,  6,  4,  7,  2,  4,  2,  0,  2,  7, 11, -1, -1, -1, -1 },
+		{  0,  1,  9,  4,  7,  8,  2,  3, 11,  5, 10,  6, -1, -1, -1, -1 },
+		{  9,  2,  1,  9, 11,  2,  9,  4, 11,  7, 11,  4,  5, 10,  6, -1 },
+		{  8,  4,  7,  3, 11,  5,  3,  5,  1,  5, 11,  6, -1, -1, -1, -1 },
+		{  5,  1, 11,  5, 11,  6,  1,  0, 11,  7, 11,  4,  0,  4, 11, -1 },
+		{  0,  5,  9,  0,  6,  5,  0,  3,  6, 11,  6,  3,  8,  4,  7, -1 },
+		{  6,  5,  9,  6,  9, 11,  4,  7,  9,  7, 11,  9, -1, -1, -1, -1 },
+		{ 10,  4,  9,  6,  4, 10, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1 },
+		{  4, 10,  6,  4,  9, 10,  0,  8,  3, -1, -1, -1, -1, -1, -1, -1 },
+		{ 10,  0,  1, 10,  6,  0,  6,  4,  0, -1, -1, -1, -1, -1, -1, -1 },
+		{  8,  3,  1,  8,  1,  6,  8,  6,  4,  6,  1, 10, -1, -1, -1, -1 },
+		{  1,  4,  9,  1,  2,  4,  2,  6,  4, -1, -1, -1, -1, -1, -1, -1 },
+		{  3,  0,  8,  1,  2,  9,  2,  4,  9,  2,  6,  4, -1, -1, -1, -1 },
+		{  0,  2,  4,  4,  2,  6, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1 },
+		{  8,  3,  2,  8,  2,  4,  4,  2,  6, -1, -1, -1, -1, -1, -1, -1 },
+		{ 10,  4,  9, 10,  6,  4, 11,  2,  3, -1, -1, -1, -1, -1, -1, -1 },
+		{  0,  8,  2,  2,  8, 11,  4,  9, 10,  4, 10,  6, -1, -1, -1, -1 },
+		{  3, 11,  2,  0,  1,  6,  0,  6,  4,  6,  1, 10, -1, -1, -1, -1 },
+		{  6,  4,  1,  6,  1, 10,  4,  8,  1,  2,  1, 11,  8, 11,  1, -1 },
+		{  9,  6,  4,  9,  3,  6,  9,  1,  3, 11,  6,  3, -1, -1, -1, -1 },
+		{  8, 11,  1,  8,  1,  0, 11,  6,  1,  9,  1,  4,  6,  4,  1, -1 },
+		{  3, 11,  6,  3,  6,  0,  0,  6,  4, -1, -1, -1, -1, -1, -1, -1 },
+		{  6,  4,  8, 11,  6,  8, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1 },
+		{  7, 10,  6,  7,  8, 10,  8,  9, 10, -1, -1, -1, -1, -1, -1, -1 },
+		{  0,  7,  3,  0, 10,  7,  0,  9, 10,  6,  7, 10, -1, -1, -1, -1 },
+		{ 10,  6,  7,  1, 10,  7,  1,  7,  8,  1,  8,  0, -1, -1, -1, -1 },
+		{ 10,  6,  7, 10,  7,  1,  1,  7,  3, -1, -1, -1, -1, -1, -1, -1 },
+		{  1,  2,  6,  1,  6,  8,  1,  8,  9,  8,  6,  7, -1, -1, -1, -1 },
+		{  2,  6,  9,  2,  9,  1,  6,  7,  9,  0,  9,  3,  7,  3,  9, -1 },
+		{  7,  8,  0,  7,  0,  6,  6,  0,  2, -1, -1, -1, -1, -1, -1, -1 },
+		{  7,  3,  2,  6,  7,  2, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1 },
+		{  2,  3, 11, 10,  6,  8, 10,  8,  9,  8,  6,  7, -1, -1, -1, -1 },
+		{  2,  0,  7,  2,  7, 11,  0,  9,  7,  6,  7, 10,  9, 10,  7, -1 },
+		{  1,  8,  0,  1,  7,  8,  1, 10,  7,  6,  7, 10,  2,  3, 11, -1 },
+		{ 11,  2,  1, 11,  1,  7, 10,  6,  1,  6,  7,  1, -1, -1, -1, -1 },
+		{  8,  9,  6,  8,  6,  7,  9,  1,  6, 11,  6,  3,  1,  3,  6, -1 },
+		{  0,  9,  1, 11,  6,  7, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1 },
+		{  7,  8,  0,  7,  0,  6,  3, 11,  0, 11,  6,  0, -1, -1, -1, -1 },
+		{  7, 11,  6, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1 },
+		{  7,  6, 11, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1 },
+		{  3,  0,  8, 11,  7,  6, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1 },
+		{  0,  1,  9, 11,  7,  6, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1 },
+		{  8,  1,  9,  8,  3,  1, 11,  7,  6, -1, -1, -1, -1, -1, -1, -1 },
+		{ 10,  1,  2,  6, 11,  7, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1 },
+		{  1,  2, 10,  3,  0,  8,  6, 11,  7, -1, -1, -1, -1, -1, -1, -1 },
+		{  2,  9,  0,  2, 10,  9,  6, 11,  7, -1, -1, -1, -1, -1, -1, -1 },
+		{  6, 11,  7,  2, 10,  3, 10,  8,  3, 10,  9,  8, -1, -1, -1, -1 },
+		{  7,  2,  3,  6,  2,  7, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1 },
+		{  7,  0,  8,  7,  6,  0,  6,  2,  0, -1, -1, -1, -1, -1, -1, -1 },
+		{  2,  7,  6,  2,  3,  7,  0,  1,  9, -1, -1, -1, -1, -1, -1, -1 },
+		{  1,  6,  2,  1,  8,  6,  1,  9,  8,  8,  7,  6, -1, -1, -1, -1 },
+		{ 10,  7,  6, 10,  1,  7,  1,  3,  7, -1, -1, -1, -1, -1, -1, -1 },
+		{ 10,  7,  6,  1,  7, 10,  1,  8,  7,  1,  0,  8, -1, -1, -1, -1 },
+		{  0,  3,  7,  0,  7, 10,  0, 10,  9,  6, 10,  7, -1, -1, -1, -1 },
+		{  7,  6, 10,  7, 10,  8,  8, 10,  9, -1, -1, -1, -1, -1, -1, -1 },
+		{  6,  8,  4, 11,  8,  6, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1 },
+		{  3,  6, 11,  3,  0,  6,  0,  4,  6, -1, -1, -1, -1, -1, -1, -1 },
+		{  8,  6, 11,  8,  4,  6,  9,  0,  1, -1, -1, -1, -1, -1, -1, -1 },
+		{  9,  4,  6,  9,  6,  3,  9,  3,  1, 11,  3,  6, -1, -1, -1, -1 },
+		{  6,  8,  4,  6, 11,  8,  2, 10,  1, -1, -1, -1, -1, -1, -1, -1 },
+		{  1,  2, 10,  3,  0, 11,  0,  6, 11,  0,  4,  6, -1, -1, -1, -1 },
+		{  4, 11,  8,  4,  6, 11,  0,  2,  9,  2, 10,  9, -1, -1, -1, -1 },
+		{ 10,  9,  3, 10,  3,  2,  9,  4,  3, 11,  3,  6,  4,  6,  3, -1 },
+		{  8,  2,  3,  8,  4,  2,  4,  6,  2, -1, -1, -1, -1, -1, -1, -1 },
+		{  0,  4,  2,  4,  6,  2, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1 },
+		{  1,  9,  0,  2,  3,  4,  2,  4,  6,  4,  3,  8, -1, -1, -1, -1 },
+		{  1,  9,  4,  1,  4,  2,  2,  4,  6, -1, -1, -1, -1, -1, -1, -1 },
+		{  8,  1,  3,  8,  6,  1,  8,  4,  6,  6, 10,  1, -1, -1, -1, -1 },
+		{ 10,  1,  0, 10,  0,  6,  6,  0,  4, -1, -1, -1, -1, -1, -1, -1 },
+		{  4,  6,  3,  4,  3,  8,  6, 10,  3,  0,  3,  9, 10,  9,  3, -1 },
+		{ 10,  9,  4,  6, 10,  4, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1 },
+		{  4,  9,  5,  7,  6, 11, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1 },
+		{  0,  8,  3,  4,  9,  5, 11,  7,  6, -1, -1, -1, -1, -1, -1, -1 },
+		{  5,  0,  1,  5,  4,  0,  7,  6, 11, -1, -1, -1, -1, -1, -1, -1 },
+		{ 11,  7,  6,  8,  3,  4,  3,  5,  4,  3,  1,  5, -1, -1, -1, -1 },
+		{  9,  5,  4, 10,  1,  2,  7,  6, 11, -1, -1, -1, -1, -1, -1, -1 },
+		{  6, 11,  7,  1,  2, 10,  0,  8,  3,  4,  9,  5, -1, -1, -1, -1 },
+		{  7,  6, 11,  5,  4, 10,  4,  2, 10,  4,  0,  2, -1, -1, -1, -1 },
+		{  3,  4,  8,  3,  5,  4,  3,  2,  5, 10,  5,  2, 11,  7,  6, -1 },
+		{  7,  2,  3,  7,  6,  2,  5,  4,  9, -1, -1, -1, -1, -1, -1, -1 },
+		{  9,  5,  4,  0,  8,  6,  0,  6,  2,  6,  8,  7, -1, -1, -1, -1 },
+		{  3,  6,  2,  3,  7,  6,  1,  5,  0,  5,  4,  0, -1, -1, -1, -1 },
+		{  6,  2,  8,  6,  8,  7,  2,  1,  8,  4,  8,  5,  1,  5,  8, -1 },
+		{  9,  5,  4, 10,  1,  6,  1,  7,  6,  1,  3,  7, -1, -1, -1, -1 },
+		{  1,  6, 10,  1,  7,  6,  1,  0,  7,  8,  7,  0,  9,  5,  4, -1 },
+		{  4,  0, 10,  4, 10,  5,  0,  3, 10,  6, 10,  7,  3,  7, 10, -1 },
+		{  7,  6, 10,  7, 10,  8,  5,  4, 10,  4,  8, 10, -1, -1, -1, -1 },
+		{  6,  9,  5,  6, 11,  9, 11,  8,  9, -1, -1, -1, -1, -1, -1, -1 },
+		{  3,  6, 11,  0,  6,  3,  0,  5,  6,  0,  9,  5, -1, -1, -1, -1 },
+		{  0, 11,  8,  0,  5, 11,  0,  1,  5,  5,  6, 11, -1, -1, -1, -1 },
+		{  6, 11,  3,  6,  3,  5,  5,  3,  1, -1, -1, -1, -1, -1, -1, -1 },
+		{  1,  2, 10,  9,  5, 11,  9, 11,  8, 11,  5,  6, -1, -1, -1, -1 },
+		{  0, 11,  3,  0,  6, 11,  0,  9,  6,  5,  6,  9,  1,  2, 10, -1 },
+		{ 11,  8,  5, 11,  5,  6,  8,  0,  5, 10,  5,  2,  0,  2,  5, -1 },
+		{  6, 11,  3,  6,  3,  5,  2, 10,  3, 10,  5,  3, -1, -1, -1, -1 },
+		{  5,  8,  9,  5,  2,  8,  5,  6,  2,  3,  8,  2, -1, -1, -1, -1 },
+		{  9,  5,  6,  9,  6,  0,  0,  6,  2, -1, -1, -1, -1, -1, -1, -1 },
+		{  1,  5,  8,  1,  8,  0,  5,  6,  8,  3,  8,  2,  6,  2,  8, -1 },
+		{  1,  5,  6,  2,  1,  6, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1 },
+		{  1,  3,  6,  1,  6, 10,  3,  8,  6,  5,  6,  9,  8,  9,  6, -1 },
+		{ 10,  1,  0, 10,  0,  6,  9,  5,  0,  5,  6,  0, -1, -1, -1, -1 },
+		{  0,  3,  8,  5,  6, 10, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1 },
+		{ 10,  5,  6, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1 },
+		{ 11,  5, 10,  7,  5, 11, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1 },
+		{ 11,  5, 10, 11,  7,  5,  8,  3,  0, -1, -1, -1, -1, -1, -1, -1 },
+		{  5, 11,  7,  5, 10, 11,  1,  9,  0, -1, -1, -1, -1, -1, -1, -1 },
+		{ 10,  7,  5, 10, 11,  7,  9,  8,  1,  8,  3,  1, -1, -1, -1, -1 },
+		{ 11,  1,  2, 11,  7,  1,  7,  5,  1, -1, -1, -1, -1, -1, -1, -1 },
+		{  0,  8,  3,  1,  2,  7,  1,  7,  5,  7,  2, 11, -1, -1, -1, -1 },
+		{  9,  7,  5,  9,  2,  7,  9,  0,  2,  2, 11,  7, -1, -1, -1, -1 },
+		{  7,  5,  2,  7,  2, 11,  5,  9,  2,  3,  2,  8,  9,  8,  2, -1 },
+		{  2,  5, 10,  2,  3,  5,  3,  7,  5, -1, -1, -1, -1, -1, -1, -1 },
+		{  8,  2,  0,  8,  5,  2,  8,  7,  5, 10,  2,  5, -1, -1, -1, -1 },
+		{  9,  0,  1,  5, 10,  3,  5,  3,  7,  3, 10,  2, -1, -1, -1, -1 },
+		{  9,  8,  2,  9,  2,  1,  8,  7,  2, 10,  2,  5,  7,  5,  2, -1 },
+		{  1,  3,  5,  3,  7,  5, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1 },
+		{  0,  8,  7,  0,  7,  1,  1,  7,  5, -1, -1, -1, -1, -1, -1, -1 },
+		{  9,  0,  3,  9,  3,  5,  5,  3,  7, -1, -1, -1, -1, -1, -1, -1 },
+		{  9,  8,  7,  5,  9,  7, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1 },
+		{  5,  8,  4,  5, 10,  8, 10, 11,  8, -1, -1, -1, -1, -1, -1, -1 },
+		{  5,  0,  4,  5, 11,  0,  5, 10, 11, 11,  3,  0, -1, -1, -1, -1 },
+		{  0,  1,  9,  8,  4, 10,  8, 10, 11, 10,  4,  5, -1, -1, -1, -1 },
+		{ 10, 11,  4, 10,  4,  5, 11,  3,  4,  9,  4,  1,  3,  1,  4, -1 },
+		{  2,  5,  1,  2,  8,  5,  2, 11,  8,  4,  5,  8, -1, -1, -1, -1 },
+		{  0,  4, 11,  0, 11,  3,  4,  5, 11,  2, 11,  1,  5,  1, 11, -1 },
+		{  0,  2,  5,  0,  5,  9,  2, 11,  5,  4,  5,  8, 11,  8,  5, -1 },
+		{  9,  4,  5,  2, 11,  3, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1 },
+		{  2,  5, 10,  3,  5,  2,  3,  4,  5,  3,  8,  4, -1, -1, -1, -1 },
+		{  5, 10,  2,  5,  2,  4,  4,  2,  0, -1, -1, -1, -1, -1, -1, -1 },
+		{  3, 10,  2,  3,  5, 10,  3,  8,  5,  4,  5,  8,  0,  1,  9, -1 },
+		{  5, 10,  2,  5,  2,  4,  1,  9,  2,  9,  4,  2, -1, -1, -1, -1 },
+		{  8,  4,  5,  8,  5,  3,  3,  5,  1, -1, -1, -1, -1, -1, -1, -1 },
+		{  0,  4,  5,  1,  0,  5, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1 },
+		{  8,  4,  5,  8,  5,  3,  9,  0,  5,  0,  3,  5, -1, -1, -1, -1 },
+		{  9,  4,  5, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1 },
+		{  4, 11,  7,  4,  9, 11,  9, 10, 11, -1, -1, -1, -1, -1, -1, -1 },
+		{  0,  8,  3,  4,  9,  7,  9, 11,  7,  9, 10, 11, -1, -1, -1, -1 },
+		{  1, 10, 11,  1, 11,  4,  1,  4,  0,  7,  4, 11, -1, -1, -1, -1 },
+		{  3,  1,  4,  3,  4,  8,  1, 10,  4,  7,  4, 11, 10, 11,  4, -1 },
+		{  4, 11,  7,  9, 11,  4,  9,  2, 11,  9,  1,  2, -1, -1, -1, -1 },
+		{  9,  7,  4,  9, 11,  7,  9,  1, 11,  2, 11,  1,  0,  8,  3, -1 },
+		{ 11,  7,  4, 11,  4,  2,  2,  4,  0, -1, -1, -1, -1, -1, -1, -1 },
+		{ 11,  7,  4, 11,  4,  2,  8,  3,  4,  3,  2,  4, -1, -1, -1, -1 },
+		{  2,  9, 10,  2,  7,  9,  2,  3,  7,  7,  4,  9, -1, -1, -1, -1 },
+		{  9, 10,  7,  9,  7,  4, 10,  2,  7,  8,  7,  0,  2,  0,  7, -1 },
+		{  3,  7, 10,  3, 10,  2,  7,  4, 10,  1, 10,  0,  4,  0, 10, -1 },
+		{  1, 10,  2,  8,  7,  4, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1 },
+		{  4,  9,  1,  4,  1,  7,  7,  1,  3, -1, -1, -1, -1, -1, -1, -1 },
+		{  4,  9,  1,  4,  1,  7,  0,  8,  1,  8,  7,  1, -1, -1, -1, -1 },
+		{  4,  0,  3,  7,  4,  3, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1 },
+		{  4,  8,  7, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1 },
+		{  9, 10,  8, 10, 11,  8, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1 },
+		{  3,  0,  9,  3,  9, 11, 11,  9, 10, -1, -1, -1, -1, -1, -1, -1 },
+		{  0,  1, 10,  0, 10,  8,  8, 10, 11, -1, -1, -1, -1, -1, -1, -1 },
+		{  3,  1, 10, 11,  3, 10, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1 },
+		{  1,  2, 11,  1, 11,  9,  9, 11,  8, -1, -1, -1, -1, -1, -1, -1 },
+		{  3,  0,  9,  3,  9, 11,  1,  2,  9,  2, 11,  9, -1, -1, -1, -1 },
+		{  0,  2, 11,  8,  0, 11, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1 },
+		{  3,  2, 11, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1 },
+		{  2,  3,  8,  2,  8, 10, 10,  8,  9, -1, -1, -1, -1, -1, -1, -1 },
+		{  9, 10,  2,  0,  9,  2, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1 },
+		{  2,  3,  8,  2,  8, 10,  0,  1,  8,  1, 10,  8, -1, -1, -1, -1 },
+		{  1, 10,  2, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1 },
+		{  1,  3,  8,  9,  1,  8, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1 },
+		{  0,  9,  1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1 },
+		{  0,  3,  8, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1 },
+		{ -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1 },
+	};
+
+	struct FTriangleCounts
+	{
+		uint8 Counts[256] = {};
+	};
+
+	constexpr FTriangleCounts MakeTriangleCounts()
+	{
+		FTriangleCounts triangleCounts;
+		for (int idxFlag = 0; idxFlag < 256; idxFlag++)
+		{
+			uint8 count = 0;
+			while (count < 5 && Triangles[idxFlag][count * 3] >= 0) count++;
+			triangleCounts.Counts[idxFlag] = count;
+		}
+		return triangleCounts;
+	}
+
+	// Triangles of each corner state, so the triangle loop doesn't look for the terminator
+	inline constexpr FTriangleCounts TriangleCounts = MakeTriangleCounts();
+
+	enum class ENormalMode : uint8
+	{
+		// One normal per triangle, from its edges
+		Flat,
+		// Density gradient at each vertex, sampled from the generator
+		Smooth
+	};
+
+	enum class EAttributes : uint8
+	{
+		// Positions and triangles only, for collision
+		Positions,
+		// Positions, normals and polygroups
+		Minimal,
+		// Every stream
+		Full
+	};
+
+	using FMeshBuilder = TRealtimeMeshBuilderLocal<uint32, FPackedNormal, FVector2DHalf, 1>;
+
+	// Everything the kernels read besides the densities, the same for the whole chunk
+	struct FChunkParams
+	{
+		int ChunkResolution = 0;
+		double Threshold = 1.0;
+
+		// Corners between two marched cells, above 1 marches a coarse preview of the same densities
+		int Step = 1;
+
+		FVector ChunkMin = FVector::ZeroVector;
+		double ChunkSize = 0.0;
+		bool bQuantizePositions = false;
+
+		int NumMaterials = 1;
+		bool bUsePolyGroups = false;
+
+		// Materials and smooth normals
+		UVoxelProceduralGenerator* Generator = nullptr;
+		double VolumeExtent = 1.0;
+		TArrayView<const FVoxelEditOp> EditOps;
+		TArrayView<const TSharedPtr<const FVoxelEditSnapshot>> EditSnapshots;
+
+		// Rendered triangles also place scatter points here when set, one per ScatterSpacing² of surface on average
+		TArray<FVoxelScatterPoint>* ScatterPoints = nullptr;
+		float ScatterSpacing = 100.f;
+	};
+
+	// Cell the surface crosses, its lowest corner and its corner state
+	struct FActiveCell
+	{
+		uint16 X = 0;
+		uint16 Y = 0;
+		uint16 Z = 0;
+		uint8 Flag = 0;
+	};
+
+	// Writes 1 for each of the first InNum densities at or below InThreshold. Doubles are compared a vector at a time,
+	// reading up to InNumReadable (the padded row length), OutInside must hold as many
+	template<typename DensityType>
+	void ClassifyRow(const DensityType* InRow, int InNum, int InNumReadable, double InThreshold, uint8* OutInside)
+	{
+		int z = 0;
+		if constexpr (std::is_same_v<DensityType, double>)
+		{
+			const VectorRegister4Double threshold = VectorLoadDouble1(&InThreshold);
+			for (; z < InNum && z + 4 <= InNumReadable; z += 4)
+			{
+				const uint32 bits = VectorMaskBits(VectorCompareLE(VectorLoad(InRow + z), threshold));
+				OutInside[z] = bits & 1;
+				OutInside[z + 1] = (bits >> 1) & 1;
+				OutInside[z + 2] = (bits >> 2) & 1;
+				OutInside[z + 3] = (bits >> 3) & 1;
+			}
+		}
+
+		for (; z < InNum; z++)
+		{
+			OutInside[z] = InRow[z] <= InThreshold;
+		}
+	}
+
+	// Corner signs are classified a row at a time, then the cells the surface crosses are listed in marching order.
+	// Returns the triangles they make, each with its own 3 vertices
+	template<typename DensityType>
+	int32 FindActiveCells(const FArray3D<DensityType>& InDensities, int InResolution, int InStep, double InThreshold, TArray<FActiveCell>& OutCells)
+	{
+		const int edgeCount = InResolution + 1;
+		const int rowLength = InDensities.GetRowStride();
+		const int numRows = InResolution / InStep + 1;
+
+		// A row of signs per (x, y) the cells use
+		TArray<uint8> inside;
+		inside.SetNumUninitialized(numRows * numRows * rowLength);
+		for (int ix = 0; ix < numRows; ix++)
+		{
+			for (int iy = 0; iy < numRows; iy++)
+			{
+				ClassifyRow(InDensities.GetRow(ix * InStep, iy * InStep).GetData(), edgeCount, rowLength, InThreshold, &inside[(ix * numRows + iy) * rowLength]);
+			}
+		}
+
+		// Corners 0 to 3 of a column of cells packed per z, a cell's state is the square below it and the one above
+		TArray<uint8> squares;
+		squares.SetNumUninitialized(edgeCount);
+
+		int32 numTriangles = 0;
+		for (int ix = 0; ix < numRows - 1; ix++)
+		{
+			for (int iy = 0; iy < numRows - 1; iy++)
+			{
+				const uint8* corner0 = &inside[(ix * numRows + iy) * rowLength];
+				const uint8* corner1 = &inside[((ix + 1) * numRows + iy) * rowLength];
+				const uint8* corner2 = &inside[((ix + 1) * numRows + iy + 1) * rowLength];
+				const uint8* corner3 = &inside[(ix * numRows + iy + 1) * rowLength];
+				for (int z = 0; z < edgeCount; z++)
+				{
+					squares[z] = corner0[z] | (corner1[z] << 1) | (corner2[z] << 2) | (corner3[z] << 3);
+				}
+
+				for (int z = 0; z < InResolution; z += InStep)
+				{
+					const uint8 flag = squares[z] | (squares[z + InStep] << 4);
+					if (!EdgeFlags[flag]) continue;
+
+					OutCells.Add({ (uint16)(ix * InStep), (uint16)(iy * InStep), (uint16)z, flag });
+					numTriangles += TriangleCounts.Counts[flag];
+				}
+			}
+		}
+
+		return numTriangles;
+	}
+
+	// Marches the cells of the chunk the surface crosses into OutBuilder, triangles of chunks with several materials go to OutMaterialTriangles
+	// instead, bucketed per material. Returns whether any triangle was made.
+	template<ENormalMode NormalMode, EAttributes Attributes, typename DensityType>
+	bool MarchChunk(const FArray3D<DensityType>& InDensities, const FChunkParams& InParams, FMeshBuilder& OutBuilder, TArray<TArray<uint32>>& OutMaterialTriangles)
+	{
+		constexpr bool bSmoothNormals = NormalMode == ENormalMode::Smooth && Attributes != EAttributes::Positions;
+
+		const int resolution = InParams.ChunkResolution;
+		const int step = InParams.Step;
+		const double threshold = InParams.Threshold;
+		const double voxelSize = InParams.ChunkSize / resolution;
+		const FVector3f chunkMin(InParams.ChunkMin);
+		const bool bMultiMaterial = Attributes != EAttributes::Positions && InParams.NumMaterials > 1;
+
+		// Corners of a cell are at fixed distances from its first corner, rows are walked linearly
+		int32 cornerDeltas[8];
+		for (int i = 0; i < 8; i++)
+		{
+			cornerDeltas[i] = InDensities.GetOffset1D(CornerOffsets[i][0] * step, CornerOffsets[i][1] * step, CornerOffsets[i][2] * step);
+		}
+
+		auto SampleDensity = [&InParams](const FVector& InLocation)
+		{
+			const double density = InParams.Generator->GenerateProceduralValue(InLocation, InParams.VolumeExtent);
+			return FVoxelEditOpGrid::Apply(InParams.EditOps, InParams.EditSnapshots, InLocation, density, InParams.Threshold);
+		};
+
+		const DensityType* densityData = InDensities.GetData();
+		double densityBuffer[8];
+		FVector3f edgeVertexBuffer[12];
+		FVector3f edgeNormalBuffer[12];
+		bool bHasAnyTriangles = false;
+
+		// Only the cells the surface crosses are marched, and the streams are sized for them once
+		TArray<FActiveCell> activeCells;
+		const int32 numChunkTriangles = FindActiveCells(InDensities, resolution, step, threshold, activeCells);
+		if (!numChunkTriangles) return false;
+
+		OutBuilder.ReserveNumVertices(numChunkTriangles * 3);
+		OutBuilder.ReserveNumTriangles(numChunkTriangles);
+
+		for (const FActiveCell& cell : activeCells)
+		{
+			const int x = cell.X;
+			const int y = cell.Y;
+			const int z = cell.Z;
+			const int idxFlag = cell.Flag;
+
+			const DensityType* cellData = densityData + InDensities.GetIndex1D(x, y, z);
+			for (int i = 0; i < 8; i++)
+			{
+				densityBuffer[i] = cellData[cornerDeltas[i]];
+			}
+
+			const uint16 edgeFlags = EdgeFlags[idxFlag];
+
+			// Surface crossing of each cut edge
+			for (int i = 0; i < 12; i++)
+			{
+				if (!(edgeFlags & (1 << i))) continue;
+
+				const int8* corner = CornerOffsets[EdgeCorners[i][0]];
+				const double c1 = densityBuffer[EdgeCorners[i][0]];
+				const double c2 = densityBuffer[EdgeCorners[i][1]];
+				const double edgeOffset = c1 == c2 ? 0.5 : FMath::Clamp((threshold - c1) / (c2 - c1), 0.0, 1.0);
+
+				const FVector3f gridPosition(
+					x + (corner[0] + EdgeDirections[i][0] * edgeOffset) * step,
+					y + (corner[1] + EdgeDirections[i][1] * edgeOffset) * step,
+					z + (corner[2] + EdgeDirections[i][2] * edgeOffset) * step
+				);
+
+				edgeVertexBuffer[i] = InParams.bQuantizePositions
+					? VoxelMeshStreams::QuantizeChunkPosition(gridPosition, resolution, InParams.ChunkMin, InParams.ChunkSize)
+					: gridPosition * voxelSize + chunkMin;
+
+				// Central differences of the density around the vertex
+				if constexpr (bSmoothNormals)
+				{
+					const FVector vertex(edgeVertexBuffer[i]);
+					edgeNormalBuffer[i].Set(
+						SampleDensity(vertex + FVector(voxelSize, 0, 0)) - SampleDensity(vertex - FVector(voxelSize, 0, 0)),
+						SampleDensity(vertex + FVector(0, voxelSize, 0)) - SampleDensity(vertex - FVector(0, voxelSize, 0)),
+						SampleDensity(vertex + FVector(0, 0, voxelSize)) - SampleDensity(vertex - FVector(0, 0, voxelSize))
+					);
+					edgeNormalBuffer[i].Normalize(0);
+				}
+			}
+
+			// Classify the cell from the samples we already have
+			const int materialIndex = bMultiMaterial ? InParams.Generator->GetMaterialIndex(densityBuffer, InParams.NumMaterials) : 0;
+
+			const uint32 cellSeed = InParams.ScatterPoints ? VoxelScatter::GetCellSeed(InParams.ChunkMin, voxelSize, x, y, z) : 0;
+
+			// Up to five triangles per cell
+			const int8* triangles = Triangles[idxFlag];
+			const uint8 numTriangles = TriangleCounts.Counts[idxFlag];
+			for (uint8 idxTriangle = 0; idxTriangle < numTriangles; idxTriangle++)
+			{
+				const int8 edgeA = triangles[idxTriangle * 3];
+				const int8 edgeB = triangles[idxTriangle * 3 + 1];
+				const int8 edgeC = triangles[idxTriangle * 3 + 2];
+
+				if constexpr (Attributes == EAttributes::Positions)
+				{
+					OutBuilder.AddTriangle(
+						OutBuilder.AddVertex(edgeVertexBuffer[edgeA]).GetIndex(),
+						OutBuilder.AddVertex(edgeVertexBuffer[edgeB]).GetIndex(),
+						OutBuilder.AddVertex(edgeVertexBuffer[edgeC]).GetIndex()
+					);
+				}
+				else
+				{
+					FVector3f flatNormal = FVector3f::ZeroVector;
+					if constexpr (!bSmoothNormals)
+					{
+						flatNormal = FVector3f::CrossProduct(
+							edgeVertexBuffer[edgeC] - edgeVertexBuffer[edgeA],
+							edgeVertexBuffer[edgeB] - edgeVertexBuffer[edgeA]
+						);
+						flatNormal.Normalize();
+					}
+
+					auto AddVertex = [&](int8 InEdgeIndex) -> uint32
+					{
+						auto vertex = OutBuilder.AddVertex(edgeVertexBuffer[InEdgeIndex]);
+						vertex.SetNormalAndTangent(bSmoothNormals ? edgeNormalBuffer[InEdgeIndex] : flatNormal, FVector3f(0, 1, 0));
+
+						if constexpr (Attributes == EAttributes::Full)
+						{
+							vertex.SetTexCoords(FVector2D());
+						}
+
+						return vertex.GetIndex();
+					};
+
+					const uint32 ia = AddVertex(edgeA);
+					const uint32 ib = AddVertex(edgeB);
+					const uint32 ic = AddVertex(edgeC);
+
+					if (InParams.ScatterPoints)
+					{
+						VoxelScatter::ScatterTriangle(
+							edgeVertexBuffer[edgeA], edgeVertexBuffer[edgeB], edgeVertexBuffer[edgeC],
+							materialIndex, cellSeed + idxTriangle, InParams.ScatterSpacing, *InParams.ScatterPoints
+						);
+					}
+
+					if (bMultiMaterial)
+					{
+						OutMaterialTriangles[materialIndex].Append({ ia, ib, ic });
+					}
+					else if (InParams.bUsePolyGroups)
+					{
+						OutBuilder.AddTriangle(ia, ib, ic, 0);
+					}
+					else
+					{
+						OutBuilder.AddTriangle(ia, ib, ic);
+					}
+				}
+
+				bHasAnyTriangles = true;
+			}
+		}
+
+		return bHasAnyTriangles;
+	}
+
+	template<typename DensityType>
+	using TKernel = bool(*)(const FArray3D<DensityType>&, const FChunkParams&, FMeshBuilder&, TArray<TArray<uint32>>&);
+
+	// Kernel for a chunk's settings, collision ignores the normal mode
+	template<typename DensityType>
+	TKernel<DensityType> SelectKernel(ENormalMode InNormalMode, EAttributes InAttributes)
+	{
+		switch (InAttributes)
+		{
+		case EAttributes::Positions:
+			return &MarchChunk<ENormalMode::Flat, EAttributes::Positions, DensityType>;
+		case EAttributes::Minimal:
+			return InNormalMode == ENormalMode::Smooth
+				? &MarchChunk<ENormalMode::Smooth, EAttributes::Minimal, DensityType>
+				: &MarchChunk<ENormalMode::Flat, EAttributes::Minimal, DensityType>;
+		default:
+			return InNormalMode == ENormalMode::Smooth
+				? &MarchChunk<ENormalMode::Smooth, EAttributes::Full, DensityType>
+				: &MarchChunk<ENormalMode::Flat, EAttributes::Full, DensityType>;
+		}
+	}
+}
@@ -0,0 +1,62 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+#include "RealtimeMeshSimple.h"
+
+namespace VoxelMeshStreams
+{
+	// Steps of the per-chunk position lattice, 16 bits per component
+	static constexpr int QuantizationSteps = MAX_uint16;
+
+	// Snaps a chunk-local grid position (0 to InResolution) onto the chunk's 16-bit lattice, then places it in the volume.
+	// Done in double from the chunk's corner so coplanar vertices of neighboring chunks land on the exact same float.
+	static FVector3f QuantizeChunkPosition(const FVector3f& InGridPosition, int InResolution, const FVector& InChunkMin, double InChunkSize)
+	{
+		// A whole number of steps per voxel, so vertices on the voxel lattice stay exactly where they are
+		const double gridToSteps = FMath::Max(QuantizationSteps / InResolution, 1);
+		const double step = InChunkSize / (gridToSteps * InResolution);
+
+		return FVector3f(
+			InChunkMin.X + FMath::RoundToDouble(InGridPosition.X * gridToSteps) * step,
+			InChunkMin.Y + FMath::RoundToDouble(InGridPosition.Y * gridToSteps) * step,
+			InChunkMin.Z + FMath::RoundToDouble(InGridPosition.Z * gridToSteps) * step
+		);
+	}
+
+	static int64 GetStreamSetSize(const FRealtimeMeshStreamSet& InStreamSet)
+	{
+		int64 size = 0;
+		InStreamSet.ForEach([&size](const FRealtimeMeshStream& Stream)
+		{
+			size += (int64)Stream.Num() * Stream.GetStride();
+		});
+
+		return size;
+	}
+
+	// Rewrites the triangle stream with 16-bit indices, does nothing if the vertices don't fit
+	static bool CompactIndicesTo16Bit(FRealtimeMeshStreamSet& InOutStreamSet, int32 InNumVertices)
+	{
+		if (InNumVertices > MAX_uint16) return false;
+
+		const FRealtimeMeshStream* triangles = InOutStreamSet.Find(FRealtimeMeshStreams::Triangles);
+		if (!triangles || !triangles->IsOfType<TIndex3<uint32>>()) return false;
+
+		const TConstArrayView<TIndex3<uint32>> source = triangles->GetArrayView<TIndex3<uint32>>();
+
+		FRealtimeMeshStream compact = FRealtimeMeshStream::Create<TIndex3<uint16>>(FRealtimeMeshStreams::Triangles);
+		compact.SetNumUninitialized(source.Num());
+
+		TArrayView<TIndex3<uint16>> dest = compact.GetArrayView<TIndex3<uint16>>();
+		for (int32 i = 0; i < source.Num(); i++)
+		{
+			dest[i] = TIndex3<uint16>(source[i].V0, source[i].V1, source[i].V2);
+		}
+
+		InOutStreamSet.AddStream(MoveTemp(compact));
+		return true;
+	}
+}
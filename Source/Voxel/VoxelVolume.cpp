@@ -2,11 +2,18 @@
 
 
 #include "VoxelVolume.h"
+#include "VoxelSubsystem.h"
 
+#include "Async/Async.h"
+#include "Async/ParallelFor.h"
+#include "EngineUtils.h"
+#include "NavigationSystem.h"
 #include "Kismet/KismetMathLibrary.h"
 #include "Kismet/GameplayStatics.h"
+#include "Camera/PlayerCameraManager.h"
 #include "Components/BillboardComponent.h"
 #include "Components/BoxComponent.h"
+#include "Components/HierarchicalInstancedStaticMeshComponent.h"
 //#include "Editor.h"
 //#include "LevelEditorViewport.h"
 
@@ -16,12 +23,14 @@
 #include "Mesh/RealtimeMeshBuilder.h"
 #include "Mesh/RealtimeMeshSimpleData.h"
 
+#include "VoxelBenchmark/VoxelStreamingStats.h"
 #include "VoxelChunk/VoxelChunkNode.h"
 #include "VoxelChunk/VoxelDirtyChunkData.h"
-#include "VoxelChunk/AsyncVoxelGenerateChunk.h"
+#include "VoxelEdit/VoxelEditRegion.h"
 #include "VoxelProceduralGeneration/VoxelProceduralGenerator.h"
-#include "VoxelUtilities/VoxelStatics.h"
 #include "VoxelUtilities/Array3D.h"
+#include "VoxelUtilities/VoxelMarchingCubes.h"
+#include "VoxelUtilities/VoxelMeshStreams.h"
 
 
 AVoxelVolume::AVoxelVolume()
@@ -32,6 +41,10 @@ AVoxelVolume::AVoxelVolume()
 	BoundingBox = CreateDefaultSubobject<UBoxComponent>(TEXT("Bounds"));
 	BoundingBox->SetupAttachment(RootComponent);
 	BoundingBox->SetCollisionEnabled(ECollisionEnabled::NoCollision);
+
+	// Referenced by its edit regions and edit RPCs, each machine builds its own chunks
+	bReplicates = true;
+	bAlwaysRelevant = true;
 }
 
 void AVoxelVolume::BeginPlay()
@@ -40,9 +53,37 @@ void AVoxelVolume::BeginPlay()
 
 	ensure(ProceduralGeneratorClass);
 
+	GenerationPipeline.SetBudgets(DensityWorkers, SurfaceWorkers, UploadPrepWorkers, PipelineQueueCapacity);
+
+	if (bUseWorldScheduler)
+	{
+		Scheduler = GetWorld()->GetSubsystem<UVoxelSubsystem>();
+		if (Scheduler) Scheduler->RegisterVolume(this);
+	}
+
 	OnGenerateMesh();
 }
 
+void AVoxelVolume::EndPlay(const EEndPlayReason::Type EndPlayReason)
+{
+	// Generations reference the volume, none may outlive it
+	ReleaseAllChunkData();
+
+	for (const TPair<FIntVector, TObjectPtr<AVoxelEditRegion>>& region : EditRegions)
+	{
+		if (region.Value) region.Value->Destroy();
+	}
+	EditRegions.Empty();
+
+	if (Scheduler)
+	{
+		Scheduler->UnregisterVolume(this);
+		Scheduler = nullptr;
+	}
+
+	Super::EndPlay(EndPlayReason);
+}
+
 void AVoxelVolume::OnConstruction(const FTransform& Transform)
 {
 	Super::OnConstruction(Transform);
@@ -50,187 +91,336 @@ void AVoxelVolume::OnConstruction(const FTransform& Transform)
 	BoundingBox->SetBoxExtent(FVector(VolumeExtent));
 }
 
-void AVoxelVolume::RegenerateChunk(FVoxelDirtyChunkData* OutChunkMeshData)
+void AVoxelVolume::FillChunkDensity(FVoxelDirtyChunkData* OutChunkMeshData, bool bParallelSlabs)
 {
-	float time = UGameplayStatics::GetTimeSeconds(this);
-	const FVector volumeLocation(GetActorLocation());
-	const FVector3f chunkLocation(OutChunkMeshData->Chunk->Location);
+	const int chunkResolution = OutChunkMeshData->ChunkResolution;
+	const FVector chunkLocation(OutChunkMeshData->Chunk->Location);
 
-	const int edgeCount = ChunkResolution + 1;
+	const int edgeCount = chunkResolution + 1;
 	const double chunkExtent = OutChunkMeshData->Chunk->GetExtent(VolumeExtent);
-	const double chunkSize = chunkExtent * 2;
-	const double voxelExtent = chunkExtent / ChunkResolution;
+
+	// A coarse preview only samples every step-th corner, the full pass fills in the rest
+	const int step = OutChunkMeshData->MeshStep;
+	const int numSlabs = chunkResolution / step + 1;
+	const double voxelExtent = chunkExtent / chunkResolution;
 	const double voxelSize = voxelExtent * 2;
 
 	auto pg = ProceduralGeneratorClass.GetDefaultObject();
 
 	FArray3D<double>& densityValues = OutChunkMeshData->CornerDensityValues;
-	FRealtimeMeshStreamSet& streamSet = OutChunkMeshData->StreamSet;
-	TRealtimeMeshBuilderLocal<uint32, FPackedNormal, FVector2DHalf, 1> builder(streamSet);
-	builder.EnableTangents();
-	builder.EnableTexCoords();
-	builder.EnablePolyGroups();
-	builder.EnableColors();
-
-	// Try to make allocations outside the loop
-	double densityBuffer[8];
-	FVector3f edgeVertexBuffer[12];
-	FVector3f edgeNormalBuffer[12];
-	int idxFlag = 0;
-	int x = 0;
-	int y = 0;
-	int z = 0;
-	int i = 0;
-	//FVector3f dotVector;
-	//FVector2D uv;
-
-	// Start marching cubes
-	for (x = 0; x < ChunkResolution; x++)
-	{
-		for (y = 0; y < ChunkResolution; y++)
-		{
-			for (z = 0; z < ChunkResolution; z++)
-			{
-				// Find values at the cube's corners
-				for (i = 0; i < 8; i++)
-				{
-					const FIntVector cornerLocationIndex =
-					{
-						x + (int)VoxelStatics::a2fVertexOffset[i][0],
-						y + (int)VoxelStatics::a2fVertexOffset[i][1],
-						z + (int)VoxelStatics::a2fVertexOffset[i][2]
-					};
 
-					if (densityValues[cornerLocationIndex] == -1.0)
-					{
-						const FVector cornerLocationWorld =
-						{
-							chunkLocation.X - chunkExtent + cornerLocationIndex.X * voxelSize,
-							chunkLocation.Y - chunkExtent + cornerLocationIndex.Y * voxelSize,
-							chunkLocation.Z - chunkExtent + cornerLocationIndex.Z * voxelSize
-						};
+	// Faces a neighbour of the same depth already sampled are copied in, the fill below skips them
+	const FVoxelChunkKey chunkKey = OutChunkMeshData->Chunk->GetKey(VolumeExtent);
+	bool bFaceConsumed[6] = { false };
+	TArray<double> faceSamples;
 
-						densityValues[cornerLocationIndex] = pg->GenerateProceduralValue(cornerLocationWorld, VolumeExtent);
-					}
-					
-					densityBuffer[i] = densityValues[cornerLocationIndex];
+	// Faces on the volume's bounds have no neighbour
+	const int numCells = 1 << chunkKey.Depth;
+	auto IsSharedFace = [&chunkKey, numCells](uint8 InFace)
+	{
+		const int plane = chunkKey.Cell[InFace / 2] + InFace % 2;
+		return 0 < plane && plane < numCells;
+	};
+
+	auto CopyFace = [&densityValues, edgeCount](uint8 InAxis, bool bInHighSide, TArray<double>& InOutSamples, bool bToDensities)
+	{
+		InOutSamples.SetNumUninitialized(edgeCount * edgeCount, false);
+
+		FIntVector index;
+		index[InAxis] = bInHighSide ? edgeCount - 1 : 0;
+		for (int u = 0; u < edgeCount; u++)
+		{
+			for (int v = 0; v < edgeCount; v++)
+			{
+				index[(InAxis + 1) % 3] = u;
+				index[(InAxis + 2) % 3] = v;
+
+				double& sample = InOutSamples[u * edgeCount + v];
+				double& density = densityValues[index];
+				if (bToDensities) density = sample;
+				else sample = density;
+			}
+		}
+	};
+
+	// Previews only have part of their faces, they are shared by the full pass
+	const bool bShareFaces = bShareBoundarySamples && step == 1;
+
+	// Last edit reaching each face, both sides gathered it, and a side generated before it was made doesn't share with one after
+	uint32 faceEditSequences[6] = { 0 };
+	if (bShareFaces)
+	{
+		const FBox chunkBox = FBox::BuildAABB(chunkLocation, FVector(chunkExtent));
+		for (uint8 idxFace = 0; idxFace < 6; idxFace++)
+		{
+			FBox faceBox = chunkBox;
+			const uint8 axis = idxFace / 2;
+			faceBox.Min[axis] = faceBox.Max[axis] = idxFace % 2 ? chunkBox.Max[axis] : chunkBox.Min[axis];
+
+			for (const FVoxelEditOp& editOp : OutChunkMeshData->EditOps)
+			{
+				if (editOp.GetBounds().Intersect(faceBox))
+				{
+					faceEditSequences[idxFace] = FMath::Max(faceEditSequences[idxFace], editOp.Sequence);
 				}
+			}
 
-				// Find which vertices are inside of the surface and which are outside
-				idxFlag = 0;
-				for (i = 0; i < 8; i++)
+			for (const TSharedPtr<const FVoxelEditSnapshot>& editSnapshot : OutChunkMeshData->EditSnapshots)
+			{
+				if (editSnapshot->GetBounds().Intersect(faceBox))
 				{
-					if (densityBuffer[i] <= ActiveDensityThreshold)
-						idxFlag |= 1 << i;
+					faceEditSequences[idxFace] = FMath::Max(faceEditSequences[idxFace], editSnapshot->Sequence);
 				}
+			}
+		}
+	}
+
+	if (bShareFaces)
+	{
+		for (uint8 idxFace = 0; idxFace < 6; idxFace++)
+		{
+			if (!IsSharedFace(idxFace)) continue;
 
-				// Find which edges are intersected by the surface
-				const int edgeFlags = VoxelStatics::aiCubeEdgeFlags[idxFlag];
+			const FVoxelBoundaryCache::FFaceKey faceKey = FVoxelBoundaryCache::MakeFaceKey(chunkKey, idxFace / 2, idxFace % 2, OutChunkMeshData->BoundaryEpoch, faceEditSequences[idxFace]);
+			if (BoundaryCache.Consume(faceKey, faceSamples) && faceSamples.Num() == edgeCount * edgeCount)
+			{
+				CopyFace(idxFace / 2, idxFace % 2, faceSamples, true);
+				bFaceConsumed[idxFace] = true;
+			}
+		}
+	}
 
-				// If the cube is entirely inside or outside of the surface,
-				// then there will be no intersections, continue to next cube
-				if (!edgeFlags) continue;
+	// Column generators only depend on (x, y), so evaluate them once per column instead of once per corner
+	FArray3D<double>& columnValues = OutChunkMeshData->ColumnValues;
+	const int numColumnGenerators = pg->GetNumColumnGenerators();
+	if (numColumnGenerators)
+	{
+		columnValues.Init(edgeCount, edgeCount, numColumnGenerators);
+	}
 
-				// Find the point of intersection of the surface with each edge
-				for (i = 0; i < 12; i++)
+	// Each x-slab only writes its own corners and columns, so they can be filled concurrently
+	auto FillSlab = [&](int32 idxSlab)
+	{
+		const int x = idxSlab * step;
+		for (int y = 0; y < edgeCount; y += step)
+		{
+			const double* columnValuesPtr = nullptr;
+			if (numColumnGenerators)
+			{
+				const FVector2D columnLocationWorld =
 				{
-					//if there is an intersection on this edge
-					if (edgeFlags & (1 << i))
-					{
-						const double c1 = densityBuffer[VoxelStatics::a2iEdgeConnection[i][0]];
-						const double c2 = densityBuffer[VoxelStatics::a2iEdgeConnection[i][1]];
-						const double edgeOffset = c1 == c2 ? 0.5 : FMath::Clamp((ActiveDensityThreshold - c1) / (c2 - c1), 0.0, 1.0);
+					chunkLocation.X - chunkExtent + x * voxelSize,
+					chunkLocation.Y - chunkExtent + y * voxelSize
+				};
 
-						edgeVertexBuffer[i].Set(
-							VoxelStatics::a2fVertexOffset[VoxelStatics::a2iEdgeConnection[i][0]][0] + x
-							+ VoxelStatics::a2fEdgeDirection[i][0] * edgeOffset,
+				double* columnValuesOut = &columnValues[columnValues.GetIndex1D(x, y, 0)];
+				pg->GenerateColumnValues(columnLocationWorld, columnValuesOut, VolumeExtent);
+				columnValuesPtr = columnValuesOut;
+			}
 
-							VoxelStatics::a2fVertexOffset[VoxelStatics::a2iEdgeConnection[i][0]][1] + y
-							+ VoxelStatics::a2fEdgeDirection[i][1] * edgeOffset,
+			TArrayView<double> densityRow = densityValues.GetRow(x, y);
+			for (int z = 0; z < edgeCount; z += step)
+			{
+				double& density = densityRow[z];
+				if (density != -1.0) continue;
 
-							VoxelStatics::a2fVertexOffset[VoxelStatics::a2iEdgeConnection[i][0]][2] + z
-							+ VoxelStatics::a2fEdgeDirection[i][2] * edgeOffset
-						);
+				const FVector cornerLocationWorld =
+				{
+					chunkLocation.X - chunkExtent + x * voxelSize,
+					chunkLocation.Y - chunkExtent + y * voxelSize,
+					chunkLocation.Z - chunkExtent + z * voxelSize
+				};
 
-						edgeVertexBuffer[i] *= voxelSize;
-						edgeVertexBuffer[i] += chunkLocation - chunkExtent;
-					}
-					else
-					{
-						edgeVertexBuffer[i] = FVector3f::ZeroVector;
-					}
+				density = columnValuesPtr
+					? pg->GenerateProceduralValue(cornerLocationWorld, columnValuesPtr, VolumeExtent)
+					: pg->GenerateProceduralValue(cornerLocationWorld, VolumeExtent);
 
-					// We get we average the density values for +x,y,z and -x,y,z
-					// Todo, take from neighboring corners that are already calculated (densityValues)
-					if (bSmoothVertexNormals)
-					{
-						const FVector3f offsetX(voxelSize, 0, 0);
-						const FVector3f offsetY(0, voxelSize, 0);
-						const FVector3f offsetZ(0, 0, voxelSize);
-
-						const FVector pX(edgeVertexBuffer[i] + offsetX);
-						const FVector pY(edgeVertexBuffer[i] + offsetY);
-						const FVector pZ(edgeVertexBuffer[i] + offsetZ);
-
-						const FVector pMX(edgeVertexBuffer[i] - offsetX);
-						const FVector pMY(edgeVertexBuffer[i] - offsetY);
-						const FVector pMZ(edgeVertexBuffer[i] - offsetZ);
-
-						edgeNormalBuffer[i].Set
-						(
-							pg->GenerateProceduralValue(pX, VolumeExtent) - pg->GenerateProceduralValue(pMX, VolumeExtent),
-							pg->GenerateProceduralValue(pY, VolumeExtent) - pg->GenerateProceduralValue(pMY, VolumeExtent),
-							pg->GenerateProceduralValue(pZ, VolumeExtent) - pg->GenerateProceduralValue(pMZ, VolumeExtent)
-						);
-
-						edgeNormalBuffer[i].Normalize(0);
-					}
-				}
+				density = FVoxelEditOpGrid::Apply(OutChunkMeshData->EditOps, OutChunkMeshData->EditSnapshots, cornerLocationWorld, density, ActiveDensityThreshold);
+			}
+		}
+	};
 
-				//Draw the triangles that were found, there can be up to five per cube
-				for (i = 0; i < 5; i++)
-				{
-					const uint8 idxTableVertex = i * 3;
-					if (VoxelStatics::a2iTriangleConnectionTable[idxFlag][idxTableVertex] < 0) break;
+	if (bParallelSlabs)
+	{
+		ParallelFor(numSlabs, FillSlab);
+	}
+	else
+	{
+		for (int idxSlab = 0; idxSlab < numSlabs; idxSlab++)
+		{
+			FillSlab(idxSlab);
+		}
+	}
 
-					const uint8 idxVertexA = VoxelStatics::a2iTriangleConnectionTable[idxFlag][idxTableVertex];
-					const uint8 idxVertexB = VoxelStatics::a2iTriangleConnectionTable[idxFlag][idxTableVertex + 1];
-					const uint8 idxVertexC = VoxelStatics::a2iTriangleConnectionTable[idxFlag][idxTableVertex + 2];
+	// Only needed while sampling
+	columnValues.Empty();
 
-					if (!bSmoothVertexNormals)
-					{
-						edgeNormalBuffer[0] = FVector3f::CrossProduct(
-							edgeVertexBuffer[idxVertexC] - edgeVertexBuffer[idxVertexA],
-							edgeVertexBuffer[idxVertexB] - edgeVertexBuffer[idxVertexA]
-						);
+	// Left for the neighbours, or if one published while we were sampling, its values are taken so the seam matches
+	if (bShareFaces)
+	{
+		for (uint8 idxFace = 0; idxFace < 6; idxFace++)
+		{
+			if (bFaceConsumed[idxFace] || !IsSharedFace(idxFace)) continue;
 
-						edgeNormalBuffer[0].Normalize();
-					}
+			CopyFace(idxFace / 2, idxFace % 2, faceSamples, false);
+			if (BoundaryCache.PublishOrAdopt(FVoxelBoundaryCache::MakeFaceKey(chunkKey, idxFace / 2, idxFace % 2, OutChunkMeshData->BoundaryEpoch, faceEditSequences[idxFace]), faceSamples))
+			{
+				CopyFace(idxFace / 2, idxFace % 2, faceSamples, true);
+			}
+		}
+	}
+}
+
+void AVoxelVolume::GenerateChunk(FVoxelDirtyChunkData* OutChunkMeshData, bool bParallelSlabs)
+{
+	for (int32 i = 0; i < FVoxelGenerationPipeline::NumStages; i++)
+	{
+		RunGenerationStage(OutChunkMeshData, (EVoxelGenerationStage)i, bParallelSlabs);
+	}
+}
+
+void AVoxelVolume::RunGenerationStage(FVoxelDirtyChunkData* OutChunkMeshData, EVoxelGenerationStage InStage, bool bParallelSlabs)
+{
+	switch (InStage)
+	{
+	case EVoxelGenerationStage::Density:
+		FillChunkDensity(OutChunkMeshData, bParallelSlabs);
+		break;
+	case EVoxelGenerationStage::Surface:
+		RegenerateChunk(OutChunkMeshData);
+		break;
+	case EVoxelGenerationStage::UploadPrep:
+		PrepareChunkUpload(OutChunkMeshData);
+		break;
+	default:
+		break;
+	}
+}
+
+void AVoxelVolume::PrepareChunkUpload(FVoxelDirtyChunkData* OutChunkMeshData)
+{
+	FRealtimeMeshStreamSet& streamSet = OutChunkMeshData->StreamSet;
+
+	// Most chunks fit in 16-bit indices, halving the index buffer
+	if (!bBuildCollisionOnly)
+	{
+		const FRealtimeMeshStream* positions = streamSet.Find(FRealtimeMeshStreams::Position);
+		VoxelMeshStreams::CompactIndicesTo16Bit(streamSet, positions ? positions->Num() : 0);
+	}
 
-					const uint32 ia = builder.AddVertex(edgeVertexBuffer[idxVertexA])
-						.SetNormalAndTangent(edgeNormalBuffer[bSmoothVertexNormals ? idxVertexA : 0], FVector3f(0, 1, 0))
-						.SetTexCoords(FVector2D())
-						.GetIndex();
+	// For queries against the displayed chunk, swapped in with its section. Previews still have unsampled corners,
+	// they leave it to the full pass
+	const FArray3D<double>& densityValues = OutChunkMeshData->CornerDensityValues;
+	if (densityValues.IsAllocated() && OutChunkMeshData->MeshStep == 1)
+	{
+		OutChunkMeshData->DensityPyramid = MakeUnique<FVoxelDensityPyramid>();
+		OutChunkMeshData->DensityPyramid->Build(densityValues, OutChunkMeshData->ChunkResolution);
+	}
 
-					const uint32 ib = builder.AddVertex(edgeVertexBuffer[idxVertexB])
-						.SetNormalAndTangent(edgeNormalBuffer[bSmoothVertexNormals ? idxVertexB : 0], FVector3f(0, 1, 0))
-						.SetTexCoords(FVector2D())
-						.GetIndex();
+	OutChunkMeshData->StreamBytes = VoxelMeshStreams::GetStreamSetSize(streamSet);
+	ChunkMemory.Add(EVoxelMemoryCategory::Streams, OutChunkMeshData->StreamBytes);
+}
 
-					const uint32 ic = builder.AddVertex(edgeVertexBuffer[idxVertexC])
-						.SetNormalAndTangent(edgeNormalBuffer[bSmoothVertexNormals ? idxVertexC : 0], FVector3f(0, 1, 0))
-						.SetTexCoords(FVector2D())
-						.GetIndex();
+void AVoxelVolume::RegenerateChunk(FVoxelDirtyChunkData* OutChunkMeshData)
+{
+	if (bBuildCollisionOnly)
+	{
+		RegenerateChunkCollision(OutChunkMeshData);
+		return;
+	}
 
-					builder.AddTriangle(ia, ib, ic, 0);
+	const int numMaterials = FMath::Max<int>(NumMaterials, 1);
+	const bool bMinimalLayout = VertexLayout == VVL_Minimal;
+	const bool bUsePolyGroups = !bMinimalLayout || numMaterials > 1;
 
-					OutChunkMeshData->bHasAnyVertices = true;
-				}
+	FRealtimeMeshStreamSet& streamSet = OutChunkMeshData->StreamSet;
+	VoxelMarchingCubes::FMeshBuilder builder(streamSet);
+	builder.EnableTangents();
+	if (!bMinimalLayout)
+	{
+		builder.EnableTexCoords();
+		builder.EnableColors();
+	}
+	if (bUsePolyGroups)
+	{
+		builder.EnablePolyGroups();
+	}
+
+	// Triangles are bucketed per material so each polygroup ends up contiguous in the index stream
+	TArray<TArray<uint32>> materialTriangles;
+	materialTriangles.SetNum(numMaterials);
+
+	VoxelMarchingCubes::FChunkParams params = MakeMarchingCubesParams(OutChunkMeshData);
+	params.NumMaterials = numMaterials;
+	params.bUsePolyGroups = bUsePolyGroups;
+
+	// Picked once, the cell loop doesn't branch on the chunk's settings
+	const auto kernel = VoxelMarchingCubes::SelectKernel<double>(
+		bSmoothVertexNormals ? VoxelMarchingCubes::ENormalMode::Smooth : VoxelMarchingCubes::ENormalMode::Flat,
+		bMinimalLayout ? VoxelMarchingCubes::EAttributes::Minimal : VoxelMarchingCubes::EAttributes::Full
+	);
+	OutChunkMeshData->bHasAnyVertices |= kernel(OutChunkMeshData->CornerDensityValues, params, builder, materialTriangles);
+
+	// Write the triangles of each material into its own polygroup
+	OutChunkMeshData->MaterialTriangleCounts.SetNumZeroed(numMaterials);
+	if (numMaterials == 1)
+	{
+		OutChunkMeshData->MaterialTriangleCounts[0] = builder.NumTriangles();
+	}
+	else
+	{
+		for (int i = 0; i < numMaterials; i++)
+		{
+			const TArray<uint32>& triangles = materialTriangles[i];
+			for (int idxTriangle = 0; idxTriangle < triangles.Num(); idxTriangle += 3)
+			{
+				builder.AddTriangle(triangles[idxTriangle], triangles[idxTriangle + 1], triangles[idxTriangle + 2], i);
 			}
+
+			OutChunkMeshData->MaterialTriangleCounts[i] = triangles.Num() / 3;
 		}
 	}
 }
 
+void AVoxelVolume::RegenerateChunkCollision(FVoxelDirtyChunkData* OutChunkMeshData)
+{
+	// Collision only reads positions and triangles, no other streams are enabled
+	VoxelMarchingCubes::FMeshBuilder builder(OutChunkMeshData->StreamSet);
+
+	TArray<TArray<uint32>> materialTriangles;
+	const auto kernel = VoxelMarchingCubes::SelectKernel<double>(VoxelMarchingCubes::ENormalMode::Flat, VoxelMarchingCubes::EAttributes::Positions);
+	OutChunkMeshData->bHasAnyVertices |= kernel(OutChunkMeshData->CornerDensityValues, MakeMarchingCubesParams(OutChunkMeshData), builder, materialTriangles);
+
+	OutChunkMeshData->MaterialTriangleCounts.Init(0, 1);
+	OutChunkMeshData->MaterialTriangleCounts[0] = builder.NumTriangles();
+}
+
+VoxelMarchingCubes::FChunkParams AVoxelVolume::MakeMarchingCubesParams(FVoxelDirtyChunkData* InChunkData)
+{
+	const double chunkExtent = InChunkData->Chunk->GetExtent(VolumeExtent);
+
+	VoxelMarchingCubes::FChunkParams params;
+	params.ChunkResolution = InChunkData->ChunkResolution;
+	params.Step = InChunkData->MeshStep;
+	params.Threshold = ActiveDensityThreshold;
+	params.ChunkMin = InChunkData->Chunk->Location - chunkExtent;
+	params.ChunkSize = chunkExtent * 2;
+	params.bQuantizePositions = bQuantizePositions;
+	params.Generator = ProceduralGeneratorClass.GetDefaultObject();
+	params.VolumeExtent = VolumeExtent;
+	params.EditOps = InChunkData->EditOps;
+	params.EditSnapshots = InChunkData->EditSnapshots;
+
+	// Previews are replaced shortly, their points would only flicker
+	if (InChunkData->MeshStep == 1 && ShouldScatter(InChunkData->Chunk))
+	{
+		params.ScatterPoints = &InChunkData->ScatterPoints;
+		params.ScatterSpacing = ScatterSpacing;
+	}
+
+	return params;
+}
+
 bool AVoxelVolume::RechunkToCenter(TMap<FVoxelChunkNode*, TArray<FVoxelChunkNode*>>& OutGroupedDirtyChunks)
 {
 	if (!RootNode)
@@ -239,20 +429,37 @@ bool AVoxelVolume::RechunkToCenter(TMap<FVoxelChunkNode*, TArray<FVoxelChunkNode
 		return false;
 	}
 
-	FVector lodCenter(0);
-	if (!GetLodCenter(lodCenter))
+	// Headless builds need detail around every player, rendering only around the local one
+	LodViews.Reset();
+	if (bBuildCollisionOnly)
 	{
-		UE_LOG(LogTemp, Warning, TEXT("[AVoxelVolume::RechunkToCenter] Could not get lod center"));
-		return false;
+		TArray<FVector> lodCenters;
+		if (!GetLodCenters(lodCenters)) return false; // no players, nothing to collide with
+
+		for (const FVector& lodCenter : lodCenters)
+		{
+			LodViews.Add(FVoxelLodView(lodCenter));
+		}
+	}
+	else
+	{
+		FVoxelLodView lodView;
+		if (!GetLodView(lodView))
+		{
+			UE_LOG(LogTemp, Warning, TEXT("[AVoxelVolume::RechunkToCenter] Could not get lod center"));
+			return false;
+		}
+
+		LodViews.Add(lodView);
 	}
 
-	RechunkToCenter(lodCenter, OutGroupedDirtyChunks, RootNode);
+	RechunkToCenter(LodViews, OutGroupedDirtyChunks, RootNode);
 
 	return OutGroupedDirtyChunks.Num() != 0;
 }
 
 void AVoxelVolume::RechunkToCenter(
-	const FVector& InLodCenter,
+	const TArray<FVoxelLodView>& InLodViews,
 	TMap<FVoxelChunkNode*, TArray<FVoxelChunkNode*>>& OutGroupedDirtyChunks,
 	FVoxelChunkNode* InMeshNode,
 	FVoxelChunkNode* InParentPreviousLeaf
@@ -265,7 +472,7 @@ void AVoxelVolume::RechunkToCenter(
 	}
 
 	if (InMeshNode->Depth == MaxDepth // at max desired node depth, this will be a leaf
-		|| !InMeshNode->IsWithinReach(InLodCenter, VolumeExtent, LodFactor) // past range to expand this node, this will be a leaf
+		|| !ShouldSubdivide(*InMeshNode, InLodViews) // past range to expand this node, this will be a leaf
 		)
 	{
 		if (!InMeshNode->IsLeaf()) // ensures old leafs aren't rechunked
@@ -300,15 +507,18 @@ void AVoxelVolume::RechunkToCenter(
 			if (!InMeshNode->Children[i])
 			{
 				InMeshNode->Children[i] = new FVoxelChunkNode(InMeshNode->Depth + 1, InMeshNode->GetChildCenter(i, VolumeExtent));
+				ChunkMemory.Add(EVoxelMemoryCategory::Nodes, sizeof(FVoxelChunkNode));
 			}
 
-			RechunkToCenter(InLodCenter, OutGroupedDirtyChunks, InMeshNode->Children[i], InParentPreviousLeaf);
+			RechunkToCenter(InLodViews, OutGroupedDirtyChunks, InMeshNode->Children[i], InParentPreviousLeaf);
 		}
 	}
 }
 
-bool AVoxelVolume::GetLodCenter(FVector& OutLocation)
+bool AVoxelVolume::GetLodCenter(FVector& OutLocation, FVector* OutVelocity)
 {
+	if (OutVelocity) *OutVelocity = FVector::ZeroVector;
+
 	if (const UWorld* world = GetWorld())
 	{
 		// first we check player pawn position
@@ -317,6 +527,7 @@ bool AVoxelVolume::GetLodCenter(FVector& OutLocation)
 			if (APawn* pawn = PC->GetPawn())
 			{
 				OutLocation = UKismetMathLibrary::InverseTransformLocation(GetActorTransform(), pawn->GetActorLocation());
+				if (OutVelocity) *OutVelocity = UKismetMathLibrary::InverseTransformDirection(GetActorTransform(), pawn->GetVelocity());
 				return true;
 			}
 		}
@@ -338,6 +549,139 @@ bool AVoxelVolume::GetLodCenter(FVector& OutLocation)
 	return false;
 }
 
+bool AVoxelVolume::GetLodCenters(TArray<FVector>& OutLocations)
+{
+	if (const UWorld* world = GetWorld())
+	{
+		for (FConstPlayerControllerIterator it = world->GetPlayerControllerIterator(); it; ++it)
+		{
+			if (const APlayerController* PC = it->Get())
+			{
+				if (APawn* pawn = PC->GetPawn())
+				{
+					OutLocations.Add(UKismetMathLibrary::InverseTransformLocation(GetActorTransform(), pawn->GetActorLocation()));
+				}
+			}
+		}
+	}
+
+	return !OutLocations.IsEmpty();
+}
+
+bool AVoxelVolume::GetLodView(FVoxelLodView& OutView, FVector* OutVelocity)
+{
+	if (!GetLodCenter(OutView.Origin, OutVelocity)) return false;
+
+	if (LodMetric != VLM_ScreenSpaceError) return true;
+
+	// Without a camera the view keeps no projection, and distance is used
+	const APlayerController* PC = GetWorld()->GetFirstPlayerController();
+	if (!PC || !PC->PlayerCameraManager) return true;
+
+	int32 viewportX = 0, viewportY = 0;
+	PC->GetViewportSize(viewportX, viewportY);
+	if (viewportX <= 0 || viewportY <= 0) // headless, size it like a common screen so results match
+	{
+		viewportX = 1920;
+		viewportY = 1080;
+	}
+
+	const FTransform& transform = GetActorTransform();
+	const APlayerCameraManager* camera = PC->PlayerCameraManager;
+
+	OutView.Origin = UKismetMathLibrary::InverseTransformLocation(transform, camera->GetCameraLocation());
+	OutView.Forward = UKismetMathLibrary::InverseTransformDirection(transform, camera->GetCameraRotation().Vector()).GetSafeNormal();
+
+	// FOV is horizontal, the cone has to reach the corners of the viewport
+	const double tanHalfFov = FMath::Tan(FMath::DegreesToRadians(camera->GetFOVAngle() * 0.5));
+	OutView.ProjectionScale = viewportX / (2 * tanHalfFov);
+	OutView.HalfFovRadians = FMath::Atan(tanHalfFov * FMath::Sqrt(1 + FMath::Square((double)viewportY / viewportX)));
+
+	return true;
+}
+
+bool AVoxelVolume::ShouldSubdivide(const FVoxelChunkNode& InNode, const TArray<FVoxelLodView>& InLodViews) const
+{
+	for (const FVoxelLodView& lodView : InLodViews)
+	{
+		if (!lodView.HasProjection())
+		{
+			if (InNode.IsWithinReach(lodView.Origin, VolumeExtent, LodFactor)) return true;
+			continue;
+		}
+
+		double screenError = InNode.GetScreenError(lodView, VolumeExtent, GetChunkResolution(InNode.Depth));
+		if (!InNode.IsInView(lodView, VolumeExtent))
+		{
+			screenError *= OffscreenErrorScale;
+		}
+
+		if (screenError > PixelErrorTolerance) return true;
+	}
+
+	return false;
+}
+
+bool AVoxelVolume::IsInAnyView(const FVoxelChunkNode& InNode) const
+{
+	for (const FVoxelLodView& lodView : LodViews)
+	{
+		if (InNode.IsInView(lodView, VolumeExtent)) return true;
+	}
+
+	return LodViews.IsEmpty();
+}
+
+float AVoxelVolume::GetGenerationImportance(const FVoxelChunkNode& InNode) const
+{
+	// Distance in chunk sizes, so volumes of any scale compare
+	double distanceInChunks = 0;
+	if (!LodViews.IsEmpty())
+	{
+		distanceInChunks = MAX_dbl;
+		for (const FVoxelLodView& lodView : LodViews)
+		{
+			const double distance = FMath::Sqrt(InNode.GetBox(VolumeExtent).ComputeSquaredDistanceToPoint(lodView.Origin));
+			distanceInChunks = FMath::Min(distanceInChunks, distance / (InNode.GetExtent(VolumeExtent) * 2));
+		}
+	}
+
+	const float importance = SchedulingImportance / (1.f + distanceInChunks);
+	return IsInAnyView(InNode) ? importance : importance * 0.5f;
+}
+
+void AVoxelVolume::GatherEditOps(const FVoxelChunkNode& InNode, FVoxelDirtyChunkData* OutChunkData) const
+{
+	if (EditOps.IsEmpty()) return;
+
+	// Normals sample a voxel past the corners
+	const FBox bounds = InNode.GetBox(VolumeExtent).ExpandBy(InNode.GetExtent(VolumeExtent) * 2 / GetChunkResolution(InNode.Depth));
+
+	EditOps.Gather(bounds, OutChunkData->EditOps);
+	EditOps.GatherSnapshots(bounds, OutChunkData->EditSnapshots);
+}
+
+void AVoxelVolume::LaunchGeneration(FVoxelDirtyChunkData* InChunkData, float InImportance, EQueuedWorkPriority InPriority)
+{
+	// Its batch waits on it from now, until the pipeline reports it done
+	BatchTracker.Track(InChunkData);
+
+	if (Scheduler)
+	{
+		// Not done either while it waits, the pipeline takes it once the scheduler starts it
+		InChunkData->GenerationStage = EVoxelGenerationStage::Density;
+		Scheduler->QueueGeneration(this, InChunkData, InImportance, InPriority);
+		return;
+	}
+
+	GenerationPipeline.Start(InChunkData, InPriority);
+}
+
+bool AVoxelVolume::ShouldCreateCollision(const FVoxelChunkNode* InNode) const
+{
+	return MaxDepth - InNode->Depth + 1 <= CollisionInverseDepth;
+}
+
 void AVoxelVolume::OnGenerateMesh_Implementation()
 {
 	Super::OnGenerateMesh_Implementation();
@@ -345,33 +689,104 @@ void AVoxelVolume::OnGenerateMesh_Implementation()
 	// Initialize the simple mesh
 	URealtimeMeshSimple* RealtimeMesh = GetRealtimeMeshComponent()->InitializeRealtimeMesh<URealtimeMeshSimple>();
 
-	// Setup the material slots
-	for (uint8 i = 0; i < NumMaterials; i++)
+	bBuildCollisionOnly = bCollisionOnly || GetNetMode() == NM_DedicatedServer;
+
+	SetupMaterialSlots(RealtimeMesh);
+
+	ReleaseAllChunkData();
+
+	if (RootNode)
 	{
-		RealtimeMesh->SetupMaterialSlot(i, FName("Material_", i));
+		ReleaseNodes(RootNode);
+		delete RootNode;
 	}
 
-	for (TPair<FVoxelChunkNode*, FVoxelDirtyChunkData*>& dirtyChunk : DirtyChunkDataMap)
+	RootNode = new FVoxelChunkNode();
+	ChunkMemory.Add(EVoxelMemoryCategory::Nodes, sizeof(FVoxelChunkNode));
+
+	// Rebucketed when the extent was changed
+	EditOps.SetVolumeExtent(VolumeExtent);
+
+	// Sections of the previous mesh are gone with it
+	TArray<short> scatteredSectionIDs;
+	ScatterComponents.GetKeys(scatteredSectionIDs);
+	for (const short sectionID : scatteredSectionIDs)
 	{
-		delete dirtyChunk.Value;
+		RemoveSectionScatter(sectionID);
 	}
 
-	DirtyChunkDataMap.Empty();
-	DirtyChunkBatches.Empty();
+	SectionIds.Reset();
 
-	if (RootNode)
+	if (bParallelInitialBuild)
 	{
-		delete RootNode;
+		BuildVolumeParallel();
+	}
+	else
+	{
+		UpdateVolume(true, true);
 	}
 
-	RootNode = new FVoxelChunkNode();
+#if WITH_EDITOR
+	// Generator edits from here on only regenerate what they change
+	TakeGeneratorSnapshot();
+	if (!GeneratorChangedHandle.IsValid())
+	{
+		GeneratorChangedHandle = FCoreUObjectDelegates::OnObjectPropertyChanged.AddUObject(this, &AVoxelVolume::OnObjectPropertyChanged);
+	}
+#endif
+}
+
+void AVoxelVolume::SetupMaterialSlots(URealtimeMeshSimple* InRealtimeMesh)
+{
+	// Biome materials map to the polygroup of the same index
+	const UVoxelProceduralGenerator* pg = ProceduralGeneratorClass.GetDefaultObject();
+	for (uint8 i = 0; i < NumMaterials && !bBuildCollisionOnly; i++)
+	{
+		UMaterialInterface* material = pg && pg->BiomeMaterialData.IsValidIndex(i) ? pg->BiomeMaterialData[i].Material.LoadSynchronous() : nullptr;
+		InRealtimeMesh->SetupMaterialSlot(i, FName("Material_", i), material);
+	}
+}
+
+void AVoxelVolume::BuildVolumeParallel()
+{
+	URealtimeMeshSimple* RealtimeMesh = GetRealtimeMeshComponent()->GetRealtimeMeshAs<URealtimeMeshSimple>();
+	if (!RealtimeMesh) return;
+
+	// Same batches as an async update, but the chunks are generated right here instead of in background tasks
+	TArray<FVoxelDirtyChunkData*> chunksToBuild;
+	TMap<FVoxelChunkNode*, TArray<FVoxelChunkNode*>> DirtyChunkGroups;
+	if (RechunkToCenter(DirtyChunkGroups))
+	{
+		RebatchDirtyChunks(DirtyChunkGroups, &chunksToBuild);
+	}
+
+	// Chunks are built concurrently, and each splits its density sampling over x-slabs.
+	// Done in waves so progress can be reported in between.
+	const int32 numChunks = chunksToBuild.Num();
+	const int32 waveSize = FMath::Max(1, FTaskGraphInterface::Get().GetNumWorkerThreads() * 2);
+
+	for (int32 idxWaveStart = 0; idxWaveStart < numChunks; idxWaveStart += waveSize)
+	{
+		const int32 numInWave = FMath::Min(waveSize, numChunks - idxWaveStart);
+
+		ParallelFor(numInWave, [this, &chunksToBuild, idxWaveStart](int32 idx)
+			{
+				GenerateChunk(chunksToBuild[idxWaveStart + idx], true);
+			},
+			EParallelForFlags::Unbalanced
+		);
+
+		UE_LOG(LogTemp, Log, TEXT("[AVoxelVolume::BuildVolumeParallel] Generated %d/%d chunks"), idxWaveStart + numInWave, numChunks);
+		OnBuildProgress.Broadcast((float)(idxWaveStart + numInWave) / numChunks);
+	}
 
-	NodeSectionIDTracker = 1;
+	// Every chunk is done, the whole volume goes out in one section update
+	UpdateVolume(false, true);
 
-	UpdateVolume(true, true);
+	OnBuildProgress.Broadcast(1.f);
 }
 
-void AVoxelVolume::RebatchDirtyChunks(TMap<FVoxelChunkNode*, TArray<FVoxelChunkNode*>>& InDirtyChunkGroups)
+void AVoxelVolume::RebatchDirtyChunks(TMap<FVoxelChunkNode*, TArray<FVoxelChunkNode*>>& InDirtyChunkGroups, TArray<FVoxelDirtyChunkData*>* OutDeferredChunks)
 {
 	for (TPair<FVoxelChunkNode*, TArray<FVoxelChunkNode*>>& group : InDirtyChunkGroups)
 	{
@@ -393,11 +808,7 @@ void AVoxelVolume::RebatchDirtyChunks(TMap<FVoxelChunkNode*, TArray<FVoxelChunkN
 					{
 						if (child->SectionID)
 						{
-							int32 idx;
-							if (group.Value.Find(child, idx))
-							{
-								group.Value.RemoveAt(idx);
-							}
+							group.Value.RemoveSingleSwap(child, false);
 						}
 					}
 				}
@@ -422,13 +833,14 @@ void AVoxelVolume::RebatchDirtyChunks(TMap<FVoxelChunkNode*, TArray<FVoxelChunkN
 			DirtyChunkBatches.Add(group.Key, group.Value);
 		}
 
+		// Possibly ready right away, its chunks may all be generated synchronously or canceled
+		BatchTracker.MarkForCheck(group.Key);
+
 		// If the key is a leaf, it's the parent that needs creation, its children need destruction (and node deletion)
 		// Note: the value array is empty, use parents direct children and recurse
 		if (group.Key->IsLeaf())
 		{
-			auto data = DirtyChunkDataMap.Add(group.Key, new FVoxelDirtyChunkData(group.Key, ChunkResolution, group.Key));
-			data->tGeneration = new FAsyncTask<AsyncVoxelGenerateChunk>(this, data);
-			data->tGeneration->StartBackgroundTask();
+			StartChunkGeneration(group.Key, group.Key, OutDeferredChunks);
 		}
 		// If the key is not a leaf, it's a parent node that was a leaf but needs deletion, the value array children need creation
 		// Note: the value array nodes possibly have greater than 1 depth from parent (could be more than 8)
@@ -436,47 +848,100 @@ void AVoxelVolume::RebatchDirtyChunks(TMap<FVoxelChunkNode*, TArray<FVoxelChunkN
 		{
 			for (FVoxelChunkNode* leaf : group.Value)
 			{
-				auto data = DirtyChunkDataMap.Add(leaf, new FVoxelDirtyChunkData(leaf, ChunkResolution, group.Key));
-				data->tGeneration = new FAsyncTask<AsyncVoxelGenerateChunk>(this, data);
-				data->tGeneration->StartBackgroundTask();
+				StartChunkGeneration(leaf, group.Key, OutDeferredChunks);
 			}
 		}
 	}
 }
 
-bool AVoxelVolume::CancelNodeSection(FVoxelChunkNode* InNode, bool bDeleteIfNotCanceled)
+FVoxelDirtyChunkData* AVoxelVolume::StartChunkGeneration(FVoxelChunkNode* InNode, FVoxelChunkNode* InBatchChunkKey, TArray<FVoxelDirtyChunkData*>* OutDeferredChunks)
 {
-	bool bCanceled = false;
+	// Replaces data left over from a generation that couldn't be canceled
+	ReleaseChunkData(DirtyChunkDataMap.FindRef(InNode));
+
+	// Generated ahead of time for this position, possibly still running
+	if (FVoxelDirtyChunkData* prefetched = AdoptPrefetchedChunk(InNode, InBatchChunkKey))
+	{
+		// Densities kept from when the node was a leaf before are superseded, and its upload retains the new ones
+		ReleaseChunkData(ChunkMemory.RemoveRetained(InNode));
+
+		prefetched->RequestTime = FPlatformTime::Seconds();
+		return DirtyChunkDataMap.Add(InNode, prefetched);
+	}
+
+	auto data = DirtyChunkDataMap.Add(InNode, new FVoxelDirtyChunkData(InNode, GetChunkResolution(InNode->Depth), InBatchChunkKey));
+	data->RequestTime = FPlatformTime::Seconds();
+	data->BoundaryEpoch = BoundaryEpoch;
+	GatherEditOps(*InNode, data);
+
+	// Without rendering, chunks too coarse for collision have nothing to build, they finish empty right away
+	if (bBuildCollisionOnly && !ShouldCreateCollision(InNode))
+	{
+		data->CornerDensityValues.Empty();
+		return data;
+	}
+
+	// Densities kept from a previous generation of this chunk don't need to be sampled again
+	FVoxelDirtyChunkData* retained = ChunkMemory.RemoveRetained(InNode);
+	const bool bHasRetainedDensities = retained != nullptr;
+	if (retained)
+	{
+		Swap(data->CornerDensityValues, retained->CornerDensityValues);
+		Swap(data->DensityBytes, retained->DensityBytes);
+		ReleaseChunkData(retained);
+	}
+	else
+	{
+		data->DensityBytes = data->CornerDensityValues.GetAllocatedSize();
+		ChunkMemory.Add(EVoxelMemoryCategory::Density, data->DensityBytes);
+	}
+
+	// Caller generates it, a data without a task is considered done
+	if (OutDeferredChunks)
+	{
+		OutDeferredChunks->Add(data);
+		return data;
+	}
+
+	// Subdivided chunks replace their parent with a coarse preview first, refined in place once it is shown.
+	// Headless collision has to be exact, and kept densities make the full pass cheap anyway
+	const int previewStep = ProgressiveStep;
+	if (bProgressiveRefinement && InBatchChunkKey != InNode && !bBuildCollisionOnly && !bHasRetainedDensities
+		&& previewStep > 1 && data->ChunkResolution % previewStep == 0 && data->ChunkResolution > previewStep)
+	{
+		data->MeshStep = previewStep;
+	}
+
+	// Chunks out of view can wait behind the ones on screen
+	LaunchGeneration(data, GetGenerationImportance(*InNode), IsInAnyView(*InNode) ? EQueuedWorkPriority::Normal : EQueuedWorkPriority::Low);
+
+	return data;
+}
+
+bool AVoxelVolume::CancelNodeSection(FVoxelChunkNode* InNode, bool bDeleteIfNotCanceled)
+{
+	bool bCanceled = false;
 
 	if (auto dirtyChunk = DirtyChunkDataMap.FindRef(InNode))
 	{
-		if (dirtyChunk->tGeneration)
+		// Still queued in the scheduler counts as canceled, it never started
+		if (dirtyChunk->bGenerationQueued || GenerationPipeline.Cancel(dirtyChunk))
 		{
-			if (!dirtyChunk->tGeneration->IsDone() && dirtyChunk->tGeneration->Cancel())
-			{
-				bCanceled = true;
-				delete dirtyChunk;
-				DirtyChunkDataMap.Remove(InNode);
-			}
+			bCanceled = true;
+			ReleaseChunkData(dirtyChunk);
+			DirtyChunkDataMap.Remove(InNode);
 		}
 
 		if (bDeleteIfNotCanceled && !bCanceled)
 		{
 			if (short id = InNode->SectionID)
 			{
-				if (URealtimeMeshSimple* RealtimeMesh = GetRealtimeMeshComponent()->GetRealtimeMeshAs<URealtimeMeshSimple>())
-				{
-					FName name = InNode->GetSectionName();
-					auto SectionGroupKey = FRealtimeMeshSectionGroupKey::Create(0, name);
-					InNode->SectionID = 0;
-
-					RealtimeMesh->RemoveSectionGroup(SectionGroupKey)
-						.Next([name](ERealtimeMeshProxyUpdateStatus Status)
-							{
-								UE_LOG(LogTemp, Warning, TEXT("RemoveSectionGroup Finished (Canceled Node) (%s)"), *name.ToString());
-							}
-					);
-				}
+				// Goes out with the rest of this update's section changes
+				AddNavigationBounds(InNode);
+				PendingSectionUpdates.AddRemove(FRealtimeMeshSectionGroupKey::Create(0, SectionIds.GetName(id)));
+				RemoveSectionScatter(id);
+				SectionIds.Release(id);
+				InNode->SectionID = 0;
 			}
 		}
 	}
@@ -487,7 +952,11 @@ bool AVoxelVolume::CancelNodeSection(FVoxelChunkNode* InNode, bool bDeleteIfNotC
 
 void AVoxelVolume::TickActor(float DeltaTime, ELevelTick TickType, FActorTickFunction& ThisTickFunction)
 {
-	UpdateVolume();
+	// The world scheduler updates its volumes in one pass
+	if (!Scheduler)
+	{
+		UpdateVolume();
+	}
 
 	Super::TickActor(DeltaTime, TickType, ThisTickFunction);
 }
@@ -497,6 +966,8 @@ void AVoxelVolume::UpdateVolume(bool bShouldRechunk, bool bSynchronous)
 	URealtimeMeshSimple* RealtimeMesh = GetRealtimeMeshComponent()->GetRealtimeMeshAs<URealtimeMeshSimple>();
 	if (!RealtimeMesh) return;
 
+	const double updateStartTime = FPlatformTime::Seconds();
+
 	// Check for dirty chunks
 	if (bShouldRechunk)
 	{
@@ -507,142 +978,1284 @@ void AVoxelVolume::UpdateVolume(bool bShouldRechunk, bool bSynchronous)
 		}
 	}
 
-	// If no dirty chunks, no update needed
-	if (!DirtyChunkDataMap.Num()) return;
+	if (!bSynchronous)
+	{
+		PrefetchPredictedChunks();
+	}
+
+	RetryDeferredNavigation();
 
-	TArray<FVoxelChunkNode*> DirtyChunkNodes;
-	DirtyChunkDataMap.GetKeys(DirtyChunkNodes);
+	// A batch is only swapped in once all of its chunks are generated, its old sections are then removed
+	// in the same section update that creates the new ones, so there is never a gap or an overlap.
+	// Asynchronously, only the batches whose generations finished since the last update are looked at
+	BatchTracker.Drain();
 
-	for (int idxNode = 0; idxNode < DirtyChunkNodes.Num(); idxNode++)
+	TArray<FVoxelChunkNode*> batchKeys;
+	if (bSynchronous)
 	{
-		if (!bSynchronous && MeshBuildingTracker.GetValue() >= MeshBuildingLimit)
-			return;
+		DirtyChunkBatches.GetKeys(batchKeys);
+	}
+	else
+	{
+		BatchTracker.GetBatchesToCheck(batchKeys);
+	}
 
-		FVoxelChunkNode* chunkNode = DirtyChunkNodes[idxNode];
-		if (!chunkNode) continue;
+	// On screen batches get the upload slots first
+	if (LodMetric == VLM_ScreenSpaceError)
+	{
+		batchKeys.StableSort([this](const FVoxelChunkNode& A, const FVoxelChunkNode& B)
+			{
+				return IsInAnyView(A) && !IsInAnyView(B);
+			}
+		);
+	}
 
-		check(0 <= chunkNode->Depth)
-		check(chunkNode->Depth <= MaxDepth)
+	// Owned here until the section updates are applied, since those read their streams
+	TArray<FVoxelDirtyChunkData*> uploadedChunkData;
+	TSet<FVoxelChunkNode*> uploadedNodes;
 
-		FVoxelDirtyChunkData* chunkData = DirtyChunkDataMap.FindRef(chunkNode);
-		if (!chunkData) continue;
+	for (FVoxelChunkNode* batchKey : batchKeys)
+	{
+		if (!bSynchronous && MeshBuildingTracker.GetValue() + PendingSectionUpdates.NumCreates() >= MeshBuildingLimit)
+			break;
 
-		if (!chunkData->tGeneration->IsDone())
+		// Batch may have been dropped along with its nodes by a previous batch of this update
+		TArray<FVoxelChunkNode*>* batchNodes = DirtyChunkBatches.Find(batchKey);
+		if (!batchNodes)
 		{
-			if (!bSynchronous) continue; // if async, we wait until next update
-
-			chunkData->tGeneration->EnsureCompletion();
+			BatchTracker.MarkChecked(batchKey);
+			continue;
 		}
 
-		if (!chunkData->bHasAnyVertices)
+		// Case 1: lower detail parent replaces all of its children
+		// Case 2: higher detail children replace their parent
+		const bool bIsParentBatch = batchKey->IsLeaf();
+
+		TArray<FVoxelChunkNode*> createdNodes;
+		TArray<FVoxelChunkNode*> replacedNodes;
+		if (bIsParentBatch)
 		{
-			chunkData->CornerDensityValues.Empty();
-			chunkData->StreamSet.Empty();
+			createdNodes.Add(batchKey);
+			replacedNodes = batchKey->GetChildren();
 		}
-		else if (!chunkNode->SectionID)
+		else
 		{
-			if (!NodeSectionIDTracker) NodeSectionIDTracker++;
-			chunkNode->SectionID = NodeSectionIDTracker++;
-
-			FName name = chunkNode->GetSectionName();
-			const auto SectionGroupKey = FRealtimeMeshSectionGroupKey::Create(0, name);
+			createdNodes = *batchNodes;
+			replacedNodes.Add(batchKey);
+		}
 
-			MeshBuildingTracker.Increment();
+		// The tracker counts the generations started for the batch, synchronous updates finish them here instead
+		bool bIsBatchReady = true;
+		if (bSynchronous)
+		{
+			for (FVoxelChunkNode* node : createdNodes)
+			{
+				bIsBatchReady &= IsChunkDataDone(node, bSynchronous);
+			}
+		}
+		else
+		{
+			bIsBatchReady = !BatchTracker.IsPending(batchKey);
+		}
 
-			//UE_LOG(LogTemp, Warning, TEXT("CreateSectionGroup Started (%s)"), *name.ToString());
+		// A created node's data may have been restarted for another batch, which uploads and drops it. Checked every
+		// update until then, its own generation isn't counted against this batch
+		bool bIsWaitingOnUpload = false;
+		if (!bSynchronous)
+		{
+			for (FVoxelChunkNode* node : createdNodes)
+			{
+				const FVoxelDirtyChunkData* chunkData = DirtyChunkDataMap.FindRef(node);
+				if (!chunkData) continue;
 
-			RealtimeMesh->CreateSectionGroup(SectionGroupKey, chunkData->StreamSet).Next
-			(
-				[this, name, chunkData](ERealtimeMeshProxyUpdateStatus Status)
+				if (chunkData->BatchChunkKey != batchKey)
 				{
-					chunkData->bMeshBuilt.AtomicSet(true);
+					bIsBatchReady = false;
+					bIsWaitingOnUpload = true;
 				}
-			);
-
-			const bool bShouldCreateCollision = MaxDepth - chunkNode->Depth + 1 <= CollisionInverseDepth;
-			RealtimeMesh->UpdateSectionConfig
-			(
-				FRealtimeMeshSectionKey::CreateForPolyGroup(SectionGroupKey, 0),
-				FRealtimeMeshSectionConfig(ERealtimeMeshSectionDrawType::Dynamic, 0),
-				bShouldCreateCollision
-			).Next
-			(
-				[this, name, chunkData](ERealtimeMeshProxyUpdateStatus Status)
+				else if (!GenerationPipeline.IsDone(chunkData))
 				{
-					UE_LOG(LogTemp, Warning, TEXT("CreateSectionGroup Finished (%s)"), *name.ToString());
-					MeshBuildingTracker.Decrement();
-					chunkData->bCollisionBuilt.AtomicSet(true);
+					bIsBatchReady = false;
+					BatchTracker.WaitOn(node, batchKey);
 				}
-			);
+			}
 		}
 
-		if (!chunkData->bHasAnyVertices || (chunkNode->SectionID && chunkData->bCollisionBuilt))
+		// Replaced nodes can still have a generation in flight that couldn't be canceled, started for another batch
+		for (FVoxelChunkNode* node : replacedNodes)
 		{
-			// Case 1:
-			// 
-			// Lower detail parent finished section, we can delete all its children now
-			if (chunkNode == chunkData->BatchChunkKey)
+			if (!IsChunkDataDone(node, bSynchronous))
+			{
+				bIsBatchReady = false;
+				BatchTracker.WaitOn(node, batchKey);
+			}
+
+			// Don't delete a node whose streams are still waiting on this update's section updates
+			bIsWaitingOnUpload |= uploadedNodes.Contains(node);
+		}
+
+		if (!bIsBatchReady || bIsWaitingOnUpload)
+		{
+			// Otherwise checked again when what it waits on completes
+			if (!bIsWaitingOnUpload)
+			{
+				BatchTracker.MarkChecked(batchKey);
+			}
+
+			continue;
+		}
+
+		// Section groups of the replaced nodes are handed to the created ones and updated in place, only the rest are removed
+		TArray<short> reusableSectionIDs;
+		for (FVoxelChunkNode* replacedNode : replacedNodes)
+		{
+			if (replacedNode->SectionID)
+			{
+				AddNavigationBounds(replacedNode);
+				reusableSectionIDs.Add(replacedNode->SectionID);
+				replacedNode->SectionID = 0;
+			}
+		}
+
+		for (FVoxelChunkNode* chunkNode : createdNodes)
+		{
+			check(0 <= chunkNode->Depth)
+			check(chunkNode->Depth <= MaxDepth)
+
+			FVoxelDirtyChunkData* chunkData = DirtyChunkDataMap.FindRef(chunkNode);
+			if (!chunkData || chunkData->BatchChunkKey != batchKey) continue;
+
+			// Prefetched data was generated against a stand-in node, its task is done so it can point to the real one
+			chunkData->Chunk = chunkNode;
+
+			if (chunkData->bHasAnyVertices || chunkNode->SectionID)
+			{
+				AddNavigationBounds(chunkNode);
+			}
+
+			if (chunkData->bHasAnyVertices)
 			{
-				TArray<FVoxelChunkNode*> children = chunkNode->GetChildren();
-				for (FVoxelChunkNode* child : children)
+				// Remeshed in place, or taking over a replaced node's group
+				bool bUpdateInPlace = chunkNode->SectionID != 0;
+				if (!bUpdateInPlace && !reusableSectionIDs.IsEmpty())
 				{
-					if (child->SectionID)
-					{
-						FName name = child->GetSectionName();
-						const auto SectionGroupKey = FRealtimeMeshSectionGroupKey::Create(0, name);
-
-						//UE_LOG(LogTemp, Warning, TEXT("RemoveSectionGroup Started (Parent Finished) (%s)"), *name.ToString());
-						RealtimeMesh->RemoveSectionGroup(SectionGroupKey)
-							.Next([name](ERealtimeMeshProxyUpdateStatus Status)
-								{
-									UE_LOG(LogTemp, Warning, TEXT("RemoveSectionGroup Finished (Parent Finished) (%s)"), *name.ToString());
-								}
-						);
-					}
+					chunkNode->SectionID = reusableSectionIDs.Pop(false);
+					bUpdateInPlace = true;
 				}
 
-				DirtyChunkBatches.Remove(chunkNode);
-				DirtyChunkDataMap.Remove(chunkNode);
+				if (!chunkNode->SectionID)
+				{
+					chunkNode->SectionID = SectionIds.Acquire();
+				}
 
-				for (uint8 i = 0; i < 8; i++)
+				if (chunkNode->SectionID)
 				{
-					delete chunkNode->Children[i];
-					chunkNode->Children[i] = nullptr;
+					PendingSectionUpdates.AddCreate
+					(
+						FRealtimeMeshSectionGroupKey::Create(0, SectionIds.GetName(chunkNode->SectionID)),
+						chunkData->StreamSet,
+						chunkData->MaterialTriangleCounts,
+						ShouldCreateCollision(chunkNode),
+						!bBuildCollisionOnly, // headless sections only exist to feed collision
+						bUpdateInPlace
+					);
+
+					UpdateSectionScatter(chunkNode->SectionID, chunkData->ScatterPoints);
 				}
 			}
-			// Case 2:
-			// 
-			// Higher detail child finished section, we can delete its parent now if all its siblings are done
-			else
+			else if (chunkNode->SectionID) // remeshed to nothing
 			{
-				if (TArray<FVoxelChunkNode*>* arrayRef = DirtyChunkBatches.Find(chunkData->BatchChunkKey))
-				{
-					arrayRef->Remove(chunkNode);
-					DirtyChunkDataMap.Remove(chunkNode);
+				PendingSectionUpdates.AddRemove(FRealtimeMeshSectionGroupKey::Create(0, SectionIds.GetName(chunkNode->SectionID)));
+				RemoveSectionScatter(chunkNode->SectionID);
+				SectionIds.Release(chunkNode->SectionID);
+				chunkNode->SectionID = 0;
+			}
 
-					if (arrayRef->IsEmpty())
-					{
-						FName name = chunkData->BatchChunkKey->GetSectionName();
-						const auto SectionGroupKey = FRealtimeMeshSectionGroupKey::Create(0, name);
-						chunkData->BatchChunkKey->SectionID = 0;
-
-						//UE_LOG(LogTemp, Warning, TEXT("RemoveSectionGroup Started (Children Finished) (%s)"), *name.ToString());
-						RealtimeMesh->RemoveSectionGroup(SectionGroupKey)
-							.Next([name](ERealtimeMeshProxyUpdateStatus Status)
-								{
-									UE_LOG(LogTemp, Warning, TEXT("RemoveSectionGroup Finished (Children Finished) (%s)"), *name.ToString());
-								}
-						);
-
-						DirtyChunkBatches.Remove(chunkData->BatchChunkKey);
-					}
+			// Queries use the pyramid of the chunk that's currently displayed
+			if (chunkData->DensityPyramid)
+			{
+				if (chunkNode->DensityPyramid)
+				{
+					ChunkMemory.Add(EVoxelMemoryCategory::Density, -(int64)chunkNode->DensityPyramid->GetAllocatedSize());
 				}
+
+				chunkNode->DensityPyramid = MoveTemp(chunkData->DensityPyramid);
+				ChunkMemory.Add(EVoxelMemoryCategory::Density, chunkNode->DensityPyramid->GetAllocatedSize());
+			}
+
+			if (StreamingStats)
+			{
+				StreamingStats->ReadyLatencies.Add(FPlatformTime::Seconds() - chunkData->RequestTime);
+			}
+
+			uploadedChunkData.Add(chunkData);
+			uploadedNodes.Add(chunkNode);
+			DirtyChunkDataMap.Remove(chunkNode);
+		}
+
+		for (const short sectionID : reusableSectionIDs)
+		{
+			PendingSectionUpdates.AddRemove(FRealtimeMeshSectionGroupKey::Create(0, SectionIds.GetName(sectionID)));
+			RemoveSectionScatter(sectionID);
+			SectionIds.Release(sectionID);
+		}
+
+		for (FVoxelChunkNode* replacedNode : replacedNodes)
+		{
+			if (FVoxelDirtyChunkData* staleData = DirtyChunkDataMap.FindRef(replacedNode))
+			{
+				ReleaseChunkData(staleData);
+				DirtyChunkDataMap.Remove(replacedNode);
+			}
+
+			// Deleted below, along with any batch they were waiting on
+			if (bIsParentBatch)
+			{
+				DirtyChunkBatches.Remove(replacedNode);
+			}
+		}
+
+		if (bIsParentBatch)
+		{
+			for (uint8 i = 0; i < 8; i++)
+			{
+				if (!batchKey->Children[i]) continue;
+
+				ReleaseNodes(batchKey->Children[i]);
+				delete batchKey->Children[i];
+				batchKey->Children[i] = nullptr;
+			}
+		}
+
+		DirtyChunkBatches.Remove(batchKey);
+		BatchTracker.MarkChecked(batchKey);
+	}
+
+	FlushSectionUpdates(RealtimeMesh);
+
+	// Section updates copied the streams, only the densities can still be worth keeping
+	for (FVoxelDirtyChunkData* chunkData : uploadedChunkData)
+	{
+		ReleaseChunkStreams(chunkData);
+
+		// Previews go straight back into the pipeline for their full pass, as a batch of their own that remeshes them in place.
+		// Not if the node is already being replaced
+		FVoxelChunkNode* chunkNode = chunkData->Chunk;
+		if (chunkData->MeshStep > 1)
+		{
+			if (chunkNode->IsLeaf() && !DirtyChunkBatches.Contains(chunkNode) && !DirtyChunkDataMap.Contains(chunkNode))
+			{
+				chunkData->MeshStep = 1;
+				chunkData->BatchChunkKey = chunkNode;
+				chunkData->bHasAnyVertices = false;
+				chunkData->MaterialTriangleCounts.Reset();
+
+				DirtyChunkBatches.Add(chunkNode, TArray<FVoxelChunkNode*>());
+				DirtyChunkDataMap.Add(chunkNode, chunkData);
+				LaunchGeneration(chunkData, GetGenerationImportance(*chunkNode), IsInAnyView(*chunkNode) ? EQueuedWorkPriority::Normal : EQueuedWorkPriority::Low);
 			}
+			else
+			{
+				ReleaseChunkData(chunkData);
+			}
+		}
+		else if (bRetainDensityValues && chunkData->bHasAnyVertices)
+		{
+			ChunkMemory.Retain(chunkData->Chunk, chunkData);
+		}
+		else
+		{
+			ReleaseChunkData(chunkData);
 		}
 	}
 
-	if (bSynchronous && DirtyChunkDataMap.Num())
+	EnforceMemoryBudget();
+
+	if (StreamingStats && !bSynchronous)
+	{
+		StreamingStats->UpdateVolumeSeconds += FPlatformTime::Seconds() - updateStartTime;
+	}
+
+	if (bSynchronous && DirtyChunkBatches.Num())
 	{
 		UpdateVolume(false, true);
 	}
-}
\ No newline at end of file
+}
+
+void AVoxelVolume::PrefetchPredictedChunks()
+{
+	if (PrefetchLookahead <= 0.f || bBuildCollisionOnly || !RootNode) return;
+
+	FVoxelLodView lodView;
+	FVector lodVelocity;
+	if (!GetLodView(lodView, &lodVelocity)) return;
+
+	PrefetchUpdateCounter++;
+
+	// Leaves the octree would have around the predicted center, that it doesn't have yet
+	TArray<TPair<FVoxelChunkKey, FVector>> missingLeaves;
+	if (!lodVelocity.IsNearlyZero())
+	{
+		FVoxelLodView predictedView = lodView;
+		predictedView.Origin += lodVelocity * PrefetchLookahead;
+		CollectPredictedLeaves(predictedView, RootNode->Depth, RootNode->Location, RootNode, missingLeaves);
+	}
+
+	int32 numInFlight = 0;
+	for (const TPair<FVoxelChunkKey, FPrefetchedChunk>& prefetched : PrefetchedChunks)
+	{
+		numInFlight += !GenerationPipeline.IsDone(prefetched.Value.ChunkData);
+	}
+
+	for (const TPair<FVoxelChunkKey, FVector>& leaf : missingLeaves)
+	{
+		if (FPrefetchedChunk* prefetched = PrefetchedChunks.Find(leaf.Key))
+		{
+			prefetched->LastPredictedUpdate = PrefetchUpdateCounter;
+			continue;
+		}
+
+		if (numInFlight >= PrefetchLimit) continue;
+
+		// Generated against a stand-in node, the octree may not have one at this position yet
+		FVoxelChunkNode* prefetchNode = new FVoxelChunkNode(leaf.Key.Depth, leaf.Value);
+		ChunkMemory.Add(EVoxelMemoryCategory::Nodes, sizeof(FVoxelChunkNode));
+
+		auto data = new FVoxelDirtyChunkData(prefetchNode, GetChunkResolution(leaf.Key.Depth), nullptr);
+		data->PrefetchNode = TUniquePtr<FVoxelChunkNode>(prefetchNode);
+		data->BoundaryEpoch = BoundaryEpoch;
+		GatherEditOps(*prefetchNode, data);
+		data->DensityBytes = data->CornerDensityValues.GetAllocatedSize();
+		ChunkMemory.Add(EVoxelMemoryCategory::Density, data->DensityBytes);
+
+		constexpr float prefetchImportanceScale = 0.1f;
+		LaunchGeneration(data, GetGenerationImportance(*prefetchNode) * prefetchImportanceScale, EQueuedWorkPriority::Low);
+		numInFlight++;
+
+		PrefetchedChunks.Add(leaf.Key, { data, PrefetchUpdateCounter });
+	}
+
+	// Predictions the pawn turned away from
+	constexpr uint32 staleUpdates = 60;
+	for (auto it = PrefetchedChunks.CreateIterator(); it; ++it)
+	{
+		if (PrefetchUpdateCounter - it->Value.LastPredictedUpdate > staleUpdates)
+		{
+			ReleaseChunkData(it->Value.ChunkData);
+			it.RemoveCurrent();
+		}
+	}
+}
+
+void AVoxelVolume::CollectPredictedLeaves(
+	const FVoxelLodView& InPredictedView,
+	uint8 InDepth,
+	const FVector& InLocation,
+	const FVoxelChunkNode* InMeshNode,
+	TArray<TPair<FVoxelChunkKey, FVector>>& OutMissingLeaves
+) const
+{
+	// Same subdivision as RechunkToCenter, walked without touching the octree
+	const FVoxelChunkNode predictedNode(InDepth, InLocation);
+
+	if (InDepth == MaxDepth || !ShouldSubdivide(predictedNode, { InPredictedView }))
+	{
+		// Already displayed or being generated
+		if (InMeshNode && InMeshNode->IsLeaf()) return;
+
+		OutMissingLeaves.Add({ predictedNode.GetKey(VolumeExtent), InLocation });
+		return;
+	}
+
+	for (int i = 0; i < 8; i++)
+	{
+		CollectPredictedLeaves(
+			InPredictedView,
+			InDepth + 1,
+			predictedNode.GetChildCenter(i, VolumeExtent),
+			InMeshNode ? InMeshNode->Children[i] : nullptr,
+			OutMissingLeaves
+		);
+	}
+}
+
+FVoxelDirtyChunkData* AVoxelVolume::AdoptPrefetchedChunk(FVoxelChunkNode* InNode, FVoxelChunkNode* InBatchChunkKey)
+{
+	FPrefetchedChunk prefetched;
+	if (!PrefetchedChunks.RemoveAndCopyValue(InNode->GetKey(VolumeExtent), prefetched)) return nullptr;
+
+	FVoxelDirtyChunkData* data = prefetched.ChunkData;
+	BatchTracker.SetBatch(data, InBatchChunkKey);
+
+	// Needed now, no longer behind the rest
+	if (data->bGenerationQueued)
+	{
+		Scheduler->UpdateImportance(data, GetGenerationImportance(*InNode), EQueuedWorkPriority::Normal);
+	}
+	else
+	{
+		GenerationPipeline.Reprioritize(data, EQueuedWorkPriority::Normal);
+	}
+
+	return data;
+}
+
+void AVoxelVolume::ReleasePrefetchedChunks()
+{
+	for (TPair<FVoxelChunkKey, FPrefetchedChunk>& prefetched : PrefetchedChunks)
+	{
+		ReleaseChunkData(prefetched.Value.ChunkData);
+	}
+
+	PrefetchedChunks.Empty();
+}
+
+void AVoxelVolume::ReleasePrefetchedChunks(const FBox& InBounds)
+{
+	for (auto it = PrefetchedChunks.CreateIterator(); it; ++it)
+	{
+		const FVoxelChunkNode* prefetchNode = it.Value().ChunkData->Chunk;
+
+		// Same margin as GatherEditOps
+		const FBox bounds = prefetchNode->GetBox(VolumeExtent).ExpandBy(prefetchNode->GetExtent(VolumeExtent) * 2 / GetChunkResolution(prefetchNode->Depth));
+		if (!bounds.Intersect(InBounds)) continue;
+
+		ReleaseChunkData(it.Value().ChunkData);
+		it.RemoveCurrent();
+	}
+}
+
+bool AVoxelVolume::IsChunkDataDone(FVoxelChunkNode* InNode, bool bSynchronous)
+{
+	FVoxelDirtyChunkData* chunkData = DirtyChunkDataMap.FindRef(InNode);
+	if (!chunkData || GenerationPipeline.IsDone(chunkData)) return true;
+
+	if (!bSynchronous) return false; // if async, we wait until next update
+
+	if (chunkData->bGenerationQueued)
+	{
+		Scheduler->StartGenerationNow(chunkData);
+	}
+
+	GenerationPipeline.EnsureCompletion(chunkData);
+	return true;
+}
+
+void AVoxelVolume::ReleaseChunkStreams(FVoxelDirtyChunkData* InChunkData)
+{
+	InChunkData->StreamSet.Empty();
+	InChunkData->ScatterPoints.Empty();
+
+	ChunkMemory.Add(EVoxelMemoryCategory::Streams, -InChunkData->StreamBytes);
+	InChunkData->StreamBytes = 0;
+}
+
+void AVoxelVolume::ReleaseChunkData(FVoxelDirtyChunkData* InChunkData)
+{
+	if (!InChunkData) return;
+
+	if (Scheduler)
+	{
+		Scheduler->RemoveGeneration(InChunkData);
+	}
+
+	// A running stage still writes into the data
+	GenerationPipeline.Remove(InChunkData);
+	BatchTracker.Untrack(InChunkData);
+
+	ChunkMemory.Add(EVoxelMemoryCategory::Density, -InChunkData->DensityBytes);
+	ChunkMemory.Add(EVoxelMemoryCategory::Streams, -InChunkData->StreamBytes);
+
+	if (InChunkData->PrefetchNode)
+	{
+		ChunkMemory.Add(EVoxelMemoryCategory::Nodes, -(int64)sizeof(FVoxelChunkNode));
+	}
+
+	delete InChunkData;
+}
+
+void AVoxelVolume::ReleaseNodes(FVoxelChunkNode* InNode)
+{
+	// InNode and all of its children are about to be deleted
+	TArray<FVoxelChunkNode*> nodes = InNode->GetChildren();
+	nodes.Add(InNode);
+
+	for (FVoxelChunkNode* node : nodes)
+	{
+		ReleaseChunkData(ChunkMemory.RemoveRetained(node));
+		BatchTracker.ForgetNode(node);
+
+		if (node->DensityPyramid)
+		{
+			ChunkMemory.Add(EVoxelMemoryCategory::Density, -(int64)node->DensityPyramid->GetAllocatedSize());
+		}
+	}
+
+	ChunkMemory.Add(EVoxelMemoryCategory::Nodes, -(int64)(nodes.Num() * sizeof(FVoxelChunkNode)));
+}
+
+void AVoxelVolume::EnforceMemoryBudget()
+{
+	if (MemoryBudgetMB <= 0) return;
+
+	const int64 budgetBytes = (int64)MemoryBudgetMB * 1024 * 1024;
+
+	int64 evictableBytes = GetEvictableMemoryBytes();
+	while (evictableBytes > budgetBytes)
+	{
+		const int64 freedBytes = ReleaseLeastRecentlyUsed();
+		if (!freedBytes) break; // only prefetches still generating left
+
+		evictableBytes -= freedBytes;
+	}
+}
+
+int64 AVoxelVolume::GetEvictableMemoryBytes() const
+{
+	int64 bytes = ChunkMemory.GetRetainedBytes();
+
+	// Prefetches still generating can't be released without waiting on them
+	for (const TPair<FVoxelChunkKey, FPrefetchedChunk>& prefetched : PrefetchedChunks)
+	{
+		const FVoxelDirtyChunkData* chunkData = prefetched.Value.ChunkData;
+		if (GenerationPipeline.IsDone(chunkData))
+		{
+			bytes += chunkData->DensityBytes + chunkData->StreamBytes;
+		}
+	}
+
+	return bytes;
+}
+
+int64 AVoxelVolume::ReleaseLeastRecentlyUsed()
+{
+	// Speculative chunks go first, the one predicted longest ago
+	FVoxelChunkKey stalestKey;
+	uint32 stalestUpdate = MAX_uint32;
+	for (const TPair<FVoxelChunkKey, FPrefetchedChunk>& prefetched : PrefetchedChunks)
+	{
+		if (prefetched.Value.LastPredictedUpdate < stalestUpdate && GenerationPipeline.IsDone(prefetched.Value.ChunkData))
+		{
+			stalestKey = prefetched.Key;
+			stalestUpdate = prefetched.Value.LastPredictedUpdate;
+		}
+	}
+
+	FVoxelDirtyChunkData* evicted = nullptr;
+	FPrefetchedChunk prefetched;
+	if (stalestUpdate != MAX_uint32 && PrefetchedChunks.RemoveAndCopyValue(stalestKey, prefetched))
+	{
+		evicted = prefetched.ChunkData;
+	}
+	else
+	{
+		evicted = ChunkMemory.EvictLeastRecentlyUsed();
+	}
+
+	if (!evicted) return 0;
+
+	const int64 freedBytes = evicted->DensityBytes + evicted->StreamBytes;
+	ReleaseChunkData(evicted);
+	return freedBytes;
+}
+
+void AVoxelVolume::ReleaseAllChunkData()
+{
+	for (TPair<FVoxelChunkNode*, FVoxelDirtyChunkData*>& dirtyChunk : DirtyChunkDataMap)
+	{
+		ReleaseChunkData(dirtyChunk.Value);
+	}
+
+	DirtyChunkDataMap.Empty();
+	DirtyChunkBatches.Empty();
+	PendingSectionUpdates.Reset();
+	ReleasePrefetchedChunks();
+	BatchTracker.Reset();
+	BoundaryCache.Empty();
+}
+
+void AVoxelVolume::FlushSectionUpdates(URealtimeMeshSimple* InRealtimeMesh)
+{
+	TArray<FBox> navigationBounds = MoveTemp(PendingNavigationBounds);
+	if (PendingSectionUpdates.IsEmpty()) return;
+
+	const int32 numCreates = PendingSectionUpdates.NumCreates();
+	MeshBuildingTracker.Add(numCreates);
+
+	PendingSectionUpdates.Apply
+	(
+		InRealtimeMesh,
+		[this, numCreates, navigationBounds = MoveTemp(navigationBounds), weakThis = TWeakObjectPtr<AVoxelVolume>(this)]()
+		{
+			MeshBuildingTracker.Subtract(numCreates);
+
+			// The navmesh is built from the new collision, so its tiles are only dirtied once the sections exist
+			if (!navigationBounds.IsEmpty())
+			{
+				AsyncTask(ENamedThreads::GameThread, [weakThis, navigationBounds]()
+					{
+						if (AVoxelVolume* volume = weakThis.Get())
+						{
+							volume->MarkNavigationDirty(navigationBounds);
+						}
+					}
+				);
+			}
+		}
+	);
+
+	// Removals of this update are issued, their names can be created again
+	SectionIds.RecycleReleased();
+}
+
+void AVoxelVolume::AddNavigationBounds(const FVoxelChunkNode* InNode)
+{
+	// Navigation is built from collision, chunks without any don't change it
+	if (bUpdateNavigation && ShouldCreateCollision(InNode))
+	{
+		PendingNavigationBounds.Add(InNode->GetBox(VolumeExtent));
+	}
+}
+
+bool AVoxelVolume::ShouldScatter(const FVoxelChunkNode* InNode) const
+{
+	return !bBuildCollisionOnly && !ScatterLayers.IsEmpty() && MaxDepth - InNode->Depth + 1 <= ScatterInverseDepth;
+}
+
+void AVoxelVolume::UpdateSectionScatter(short InSectionID, const TArray<FVoxelScatterPoint>& InPoints)
+{
+	if (InPoints.IsEmpty())
+	{
+		RemoveSectionScatter(InSectionID);
+		return;
+	}
+
+	// Layers are tried in order, the first one the point's biome, slope and roll match takes it
+	TArray<TArray<FTransform>> layerInstances;
+	layerInstances.SetNum(ScatterLayers.Num());
+	for (const FVoxelScatterPoint& point : InPoints)
+	{
+		FRandomStream random((int32)point.Seed);
+		for (int idxLayer = 0; idxLayer < ScatterLayers.Num(); idxLayer++)
+		{
+			const FVoxelScatterLayer& layer = ScatterLayers[idxLayer];
+			if (!layer.Mesh) continue;
+			if (layer.Biome >= 0 && layer.Biome != point.Biome) continue;
+			if (point.Normal.Z < FMath::Cos(FMath::DegreesToRadians(layer.MaxSlope))) continue;
+			if (random.GetFraction() >= layer.Probability) continue;
+
+			FQuat rotation(FVector::UpVector, random.FRandRange(0.f, UE_TWO_PI));
+			if (layer.bAlignToNormal)
+			{
+				rotation = FQuat::FindBetweenNormals(FVector::UpVector, FVector(point.Normal)) * rotation;
+			}
+
+			const float scale = random.FRandRange(layer.ScaleRange.Min, layer.ScaleRange.Max);
+			layerInstances[idxLayer].Add(FTransform(rotation, FVector(point.Position), FVector(scale)));
+			break;
+		}
+	}
+
+	// Components are kept while the section is, only their instances are replaced
+	TArray<TObjectPtr<UHierarchicalInstancedStaticMeshComponent>>& components = ScatterComponents.FindOrAdd(InSectionID);
+	components.SetNum(ScatterLayers.Num());
+	for (int idxLayer = 0; idxLayer < ScatterLayers.Num(); idxLayer++)
+	{
+		TObjectPtr<UHierarchicalInstancedStaticMeshComponent>& component = components[idxLayer];
+		if (component)
+		{
+			component->ClearInstances();
+		}
+
+		if (layerInstances[idxLayer].IsEmpty()) continue;
+
+		if (!component)
+		{
+			component = NewObject<UHierarchicalInstancedStaticMeshComponent>(this);
+			component->SetStaticMesh(ScatterLayers[idxLayer].Mesh);
+			component->SetCollisionEnabled(ECollisionEnabled::NoCollision);
+			component->SetCanEverAffectNavigation(false);
+			component->SetupAttachment(GetRootComponent());
+			component->RegisterComponent();
+			AddInstanceComponent(component);
+		}
+
+		// Points are in the volume's space, like the sections
+		component->AddInstances(layerInstances[idxLayer], false);
+	}
+}
+
+void AVoxelVolume::RemoveSectionScatter(short InSectionID)
+{
+	TArray<TObjectPtr<UHierarchicalInstancedStaticMeshComponent>> components;
+	if (!ScatterComponents.RemoveAndCopyValue(InSectionID, components)) return;
+
+	for (UHierarchicalInstancedStaticMeshComponent* component : components)
+	{
+		if (component)
+		{
+			component->DestroyComponent();
+		}
+	}
+}
+
+void AVoxelVolume::MarkNavigationDirty(const TArray<FBox>& InBounds)
+{
+	UWorld* world = GetWorld();
+	UNavigationSystemV1* navigationSystem = FNavigationSystem::GetCurrent<UNavigationSystemV1>(world);
+	if (!navigationSystem) return;
+
+	// Agents are any pawn, player or AI controlled
+	TArray<FVector> agentLocations;
+	if (NavigationRadius > 0)
+	{
+		for (TActorIterator<APawn> it(world); it; ++it)
+		{
+			agentLocations.Add(it->GetActorLocation());
+		}
+	}
+
+	const FTransform& transform = GetActorTransform();
+	const double radiusSquared = FMath::Square((double)NavigationRadius);
+
+	for (const FBox& localBounds : InBounds)
+	{
+		const FBox bounds = localBounds.TransformBy(transform);
+
+		bool bIsNearAgent = NavigationRadius <= 0;
+		for (const FVector& agentLocation : agentLocations)
+		{
+			if (bounds.ComputeSquaredDistanceToPoint(agentLocation) <= radiusSquared)
+			{
+				bIsNearAgent = true;
+				break;
+			}
+		}
+
+		if (bIsNearAgent)
+		{
+			navigationSystem->AddDirtyArea(bounds, ENavigationDirtyFlag::All);
+			DeferredNavigationBounds.Remove(localBounds.GetCenter());
+		}
+		else
+		{
+			// Its tiles stay stale until an agent gets there
+			DeferredNavigationBounds.Add(localBounds.GetCenter(), localBounds);
+		}
+	}
+}
+
+void AVoxelVolume::RetryDeferredNavigation()
+{
+	if (DeferredNavigationBounds.IsEmpty()) return;
+
+	// Agents move slowly compared to updates
+	constexpr double retryInterval = 1.0;
+	const double now = FPlatformTime::Seconds();
+	if (now < NextDeferredNavigationTime) return;
+
+	NextDeferredNavigationTime = now + retryInterval;
+
+	TArray<FBox> bounds;
+	DeferredNavigationBounds.GenerateValueArray(bounds);
+	MarkNavigationDirty(bounds);
+}
+
+void AVoxelVolume::ApplyEdit(EVoxelEditShape Shape, EVoxelEditOperation Operation, const FVector& WorldLocation, float Radius)
+{
+	if (!HasAuthority())
+	{
+		UE_LOG(LogTemp, Warning, TEXT("[AVoxelVolume::ApplyEdit] Clients edit through a UVoxelEditComponent"));
+		return;
+	}
+
+	if (WorldLocation.ContainsNaN() || !FMath::IsFinite(Radius) || Radius <= 0.f) return;
+
+	FVoxelEditOp op;
+	op.Shape = Shape;
+	op.Operation = Operation;
+	op.Location = UKismetMathLibrary::InverseTransformLocation(GetActorTransform(), WorldLocation);
+	op.Radius = FMath::Min(Radius, MaxEditRadius);
+
+	// In the volume's space, scaled actors included. Ops that can't reach it would only grow the log
+	if (!FBox::BuildAABB(FVector::ZeroVector, FVector(VolumeExtent)).ExpandBy(op.Radius).IsInside(op.Location))
+	{
+		UE_LOG(LogTemp, Warning, TEXT("[AVoxelVolume::ApplyEdit] Edit at %s is outside the volume"), *WorldLocation.ToString());
+		return;
+	}
+
+	// Applied here exactly as clients will receive it
+	op.Quantize();
+	op.Sequence = NextEditSequence++;
+
+	EditOps.SetVolumeExtent(VolumeExtent);
+	FindOrSpawnEditRegion(EditOps.GetCell(op.Location))->AddOp(op);
+	AddEditOps({ op });
+}
+
+FBox AVoxelVolume::GetEditableBounds() const
+{
+	return FBox::BuildAABB(FVector::ZeroVector, FVector(VolumeExtent)).TransformBy(GetActorTransform());
+}
+
+void AVoxelVolume::AddEditOps(const TArray<FVoxelEditOp>& InOps)
+{
+	if (InOps.IsEmpty()) return;
+
+	// Ops may be replicated before the volume first generates
+	EditOps.SetVolumeExtent(VolumeExtent);
+
+	// Replicated ops aren't guaranteed to arrive in order, the grid inserts them in sequence order as the brushes don't commute
+	FBox editBounds(ForceInit);
+	for (const FVoxelEditOp& editOp : InOps)
+	{
+		if (!EditOps.Add(editOp)) continue;
+
+		editBounds += editOp.GetBounds();
+		if (EditRecording) EditRecording->Add(editOp);
+	}
+
+	NextEditSequence = FMath::Max(NextEditSequence, EditOps.GetLastSequence() + 1);
+
+	if (!editBounds.IsValid) return; // all received before
+
+	// Cells with enough ops are collapsed, the server's bakes replicate to the clients
+	if (HasAuthority())
+	{
+		const FIntVector minCell = EditOps.GetCell(editBounds.Min);
+		const FIntVector maxCell = EditOps.GetCell(editBounds.Max);
+		for (int x = minCell.X; x <= maxCell.X; x++)
+		{
+			for (int y = minCell.Y; y <= maxCell.Y; y++)
+			{
+				for (int z = minCell.Z; z <= maxCell.Z; z++)
+				{
+					LaunchEditSnapshot(FIntVector(x, y, z));
+				}
+			}
+		}
+	}
+
+	RegenerateEditedChunks(editBounds);
+}
+
+void AVoxelVolume::AddEditSnapshot(const TSharedRef<const FVoxelEditSnapshot>& InSnapshot)
+{
+	EditOps.SetVolumeExtent(VolumeExtent);
+
+	const TSharedPtr<const FVoxelEditSnapshot> previous = EditOps.GetSnapshot(InSnapshot->Cell);
+	if (previous && previous->Sequence >= InSnapshot->Sequence) return;
+
+	EditOps.AddSnapshot(InSnapshot);
+
+	if (HasAuthority())
+	{
+		// Collapsed ops aren't sent to late joiners anymore, an op may be centred in a neighbouring cell
+		for (const TPair<FIntVector, TObjectPtr<AVoxelEditRegion>>& region : EditRegions)
+		{
+			region.Value->RemoveCollapsedOps(EditOps);
+		}
+
+		// Its chunks were generated from the same ops, the float deltas only differ from them by rounding
+		return;
+	}
+
+	FBox editBounds = InSnapshot->GetEditedBounds();
+	if (previous) editBounds += previous->GetEditedBounds();
+
+	if (editBounds.IsValid) RegenerateEditedChunks(editBounds);
+}
+
+void AVoxelVolume::RegenerateEditedChunks(const FBox& InEditBounds)
+{
+	// Only what the edit reaches is stale. Generations still running there publish faces keyed by their last edit,
+	// which the regenerated neighbours never consume, those already cached are dropped here
+	ReleasePrefetchedChunks(InEditBounds);
+	RemoveBoundaryFaces(InEditBounds);
+
+	if (!RootNode) return; // applied when the chunks are first generated
+
+	TMap<FVoxelChunkNode*, TArray<FVoxelChunkNode*>> DirtyChunkGroups;
+	CollectEditedLeaves(RootNode, InEditBounds, DirtyChunkGroups);
+
+	if (DirtyChunkGroups.Num())
+	{
+		RebatchDirtyChunks(DirtyChunkGroups);
+	}
+}
+
+AVoxelEditRegion* AVoxelVolume::FindOrSpawnEditRegion(const FIntVector& InCell)
+{
+	if (AVoxelEditRegion* region = EditRegions.FindRef(InCell)) return region;
+
+	AVoxelEditRegion* region = GetWorld()->SpawnActor<AVoxelEditRegion>();
+	region->Init(this, InCell);
+	EditRegions.Add(InCell, region);
+
+	return region;
+}
+
+void AVoxelVolume::LaunchEditSnapshot(const FIntVector& InCell)
+{
+	const TArray<FVoxelEditOp>* bucket = EditOps.GetBucket(InCell);
+	const int32 numOps = FMath::Max(EditSnapshotThreshold, EditSnapshotRetryOps.FindRef(InCell));
+	if (!bucket || bucket->Num() < numOps || BakingEditCells.Contains(InCell)) return;
+
+	BakingEditCells.Add(InCell);
+
+	// On the finest voxels, so every chunk's corners are lattice points
+	const double finestVoxelSize = VolumeExtent * 2 / exp2(MaxDepth) / GetChunkResolution(MaxDepth);
+
+	// Ops made while it bakes come after it
+	TSharedRef<FVoxelEditSnapshot> snapshot = MakeShared<FVoxelEditSnapshot>();
+	snapshot->InitLattice(InCell, VolumeExtent, FVoxelEditSnapshot::GetNumPoints(EditOps.GetCellSize(), finestVoxelSize));
+	snapshot->Sequence = NextEditSequence++;
+
+	AsyncTask(ENamedThreads::AnyBackgroundThreadNormalTask,
+		[weakThis = TWeakObjectPtr<AVoxelVolume>(this), snapshot, ops = *bucket, previous = EditOps.GetSnapshot(InCell),
+		generator = ProceduralGeneratorClass.GetDefaultObject(), threshold = ActiveDensityThreshold]()
+		{
+			TArray<FVoxelEditBrickItem> bricks;
+			bool bBaked = snapshot->Bake(generator, threshold, previous.Get(), ops);
+			for (const TPair<FIntVector, TArray<float>>& brick : snapshot->Bricks)
+			{
+				if (!bBaked) break;
+
+				FVoxelEditBrickItem& item = bricks.AddDefaulted_GetRef();
+				item.Brick = brick.Key;
+				item.Sequence = snapshot->Sequence;
+				bBaked = FVoxelEditSnapshot::CompressBrick(brick.Value, item.Data.Bytes);
+			}
+
+			AsyncTask(ENamedThreads::GameThread, [weakThis, snapshot, bBaked, bricks = MoveTemp(bricks)]() mutable
+				{
+					if (AVoxelVolume* volume = weakThis.Get())
+					{
+						volume->OnEditSnapshotBaked(snapshot, bBaked, MoveTemp(bricks));
+					}
+				}
+			);
+		}
+	);
+}
+
+void AVoxelVolume::OnEditSnapshotBaked(const TSharedRef<FVoxelEditSnapshot>& InSnapshot, bool bInBaked, TArray<FVoxelEditBrickItem>&& InBricks)
+{
+	const FIntVector cell = InSnapshot->Cell;
+	BakingEditCells.Remove(cell);
+
+	if (!bInBaked)
+	{
+		// Not tried again before the cell has twice the ops
+		const TArray<FVoxelEditOp>* bucket = EditOps.GetBucket(cell);
+		EditSnapshotRetryOps.Add(cell, bucket ? bucket->Num() * 2 : EditSnapshotThreshold);
+
+		UE_LOG(LogTemp, Warning, TEXT("[AVoxelVolume::OnEditSnapshotBaked] Edits of cell %s weren't collapsed (more than %d bricks?), they stay ops"), *cell.ToString(), FVoxelEditSnapshot::MaxBricks);
+		return;
+	}
+
+	EditSnapshotRetryOps.Remove(cell);
+
+	// Baked for cells the grid no longer has
+	if (InSnapshot->VolumeExtent != VolumeExtent) return;
+
+	FindOrSpawnEditRegion(cell)->SetSnapshot(*InSnapshot, MoveTemp(InBricks));
+	AddEditSnapshot(InSnapshot);
+
+	// Ops made while it baked may be enough for the next one
+	LaunchEditSnapshot(cell);
+}
+
+void AVoxelVolume::RemoveBoundaryFaces(const FBox& InBounds)
+{
+	BoundaryCache.RemoveIf([this, &InBounds](const FVoxelBoundaryCache::FFaceKey& InKey)
+		{
+			const double cellSize = VolumeExtent * 2 / exp2(InKey.Depth);
+
+			FBox faceBox(FVector(InKey.Plane) * cellSize - VolumeExtent, (FVector(InKey.Plane) + 1) * cellSize - VolumeExtent);
+			faceBox.Max[InKey.Axis] = faceBox.Min[InKey.Axis];
+
+			// Same margin as GatherEditOps, sides of the face gathered the edit if it reached their expanded box
+			const double voxelSize = cellSize / GetChunkResolution(InKey.Depth);
+			return faceBox.ExpandBy(voxelSize).Intersect(InBounds);
+		}
+	);
+}
+
+void AVoxelVolume::CollectEditedLeaves(FVoxelChunkNode* InNode, const FBox& InEditBounds, TMap<FVoxelChunkNode*, TArray<FVoxelChunkNode*>>& OutGroupedDirtyChunks)
+{
+	if (!InNode) return;
+
+	// Same margin as GatherEditOps
+	const FBox bounds = InNode->GetBox(VolumeExtent).ExpandBy(InNode->GetExtent(VolumeExtent) * 2 / GetChunkResolution(InNode->Depth));
+	if (!bounds.Intersect(InEditBounds)) return;
+
+	ReleaseChunkData(ChunkMemory.RemoveRetained(InNode));
+
+	// Leaves regenerate in place, a batch keyed by a leaf creates it and removes nothing else
+	if (InNode->IsLeaf())
+	{
+		// Still to be created by a pending batch, it starts over in that batch so the batch doesn't upload without it
+		const FVoxelDirtyChunkData* chunkData = DirtyChunkDataMap.FindRef(InNode);
+		if (chunkData && chunkData->BatchChunkKey != InNode && DirtyChunkBatches.Contains(chunkData->BatchChunkKey))
+		{
+			StartChunkGeneration(InNode, chunkData->BatchChunkKey);
+			return;
+		}
+
+		OutGroupedDirtyChunks.FindOrAdd(InNode);
+		return;
+	}
+
+	for (FVoxelChunkNode* child : InNode->Children)
+	{
+		CollectEditedLeaves(child, InEditBounds, OutGroupedDirtyChunks);
+	}
+}
+
+#if WITH_EDITOR
+void AVoxelVolume::BeginDestroy()
+{
+	FCoreUObjectDelegates::OnObjectPropertyChanged.Remove(GeneratorChangedHandle);
+	GeneratorChangedHandle.Reset();
+
+	Super::BeginDestroy();
+}
+
+void AVoxelVolume::TakeGeneratorSnapshot()
+{
+	ValueGeneratorSnapshots.Reset();
+	ColumnGeneratorSnapshots.Reset();
+	BiomeMaterialSnapshot.Reset();
+	SnapshotGeneratorClass = ProceduralGeneratorClass;
+
+	const UVoxelProceduralGenerator* pg = ProceduralGeneratorClass.GetDefaultObject();
+	if (!pg) return;
+
+	for (const TObjectPtr<UVoxelProcGen_ValueGenerator>& gen : pg->ValueGenerators)
+	{
+		ValueGeneratorSnapshots.Add(gen ? DuplicateObject(gen.Get(), this) : nullptr);
+	}
+
+	for (const TObjectPtr<UVoxelProcGen_ColumnGenerator>& gen : pg->ColumnGenerators)
+	{
+		ColumnGeneratorSnapshots.Add(gen ? DuplicateObject(gen.Get(), this) : nullptr);
+	}
+
+	BiomeMaterialSnapshot = pg->BiomeMaterialData;
+}
+
+void AVoxelVolume::OnObjectPropertyChanged(UObject* InObject, FPropertyChangedEvent& InEvent)
+{
+	// Dragged values regenerate once released
+	if (!RootNode || !InObject || InEvent.ChangeType == EPropertyChangeType::Interactive) return;
+
+	// The generator's defaults, or one of the generators instanced in them
+	const UVoxelProceduralGenerator* pg = ProceduralGeneratorClass.GetDefaultObject();
+	if (!pg || (InObject != pg && InObject->GetOuter() != pg)) return;
+
+	RegenerateForGeneratorChanges();
+}
+
+void AVoxelVolume::RegenerateForGeneratorChanges()
+{
+	URealtimeMeshSimple* RealtimeMesh = GetRealtimeMeshComponent()->GetRealtimeMeshAs<URealtimeMeshSimple>();
+	if (!RealtimeMesh || !RootNode) return;
+
+	const UVoxelProceduralGenerator* pg = ProceduralGeneratorClass.GetDefaultObject();
+
+	bool bMaterialsChanged = BiomeMaterialSnapshot.Num() != pg->BiomeMaterialData.Num();
+	for (int i = 0; i < BiomeMaterialSnapshot.Num() && !bMaterialsChanged; i++)
+	{
+		bMaterialsChanged = BiomeMaterialSnapshot[i].Isovalue != pg->BiomeMaterialData[i].Isovalue
+			|| BiomeMaterialSnapshot[i].Material != pg->BiomeMaterialData[i].Material;
+	}
+
+	if (bMaterialsChanged)
+	{
+		SetupMaterialSlots(RealtimeMesh);
+	}
+
+	// Generations still running were sampled with the previous settings, they keep publishing under the previous epoch
+	BoundaryEpoch++;
+	BoundaryCache.Empty();
+	ReleasePrefetchedChunks();
+
+	TMap<FVoxelChunkNode*, TArray<FVoxelChunkNode*>> DirtyChunkGroups;
+	if (bMaterialsChanged)
+	{
+		// Every cell may have changed material
+		CollectEditedLeaves(RootNode, RootNode->GetBox(VolumeExtent), DirtyChunkGroups);
+	}
+	else
+	{
+		CollectGeneratorChangedLeaves(RootNode, DirtyChunkGroups);
+	}
+
+	// Generations still running were started with the previous settings, they start over in the same batch.
+	// Those of the current epoch were just restarted by CollectEditedLeaves
+	TArray<TPair<FVoxelChunkNode*, FVoxelChunkNode*>> staleGenerations;
+	for (const TPair<FVoxelChunkNode*, FVoxelDirtyChunkData*>& dirtyChunk : DirtyChunkDataMap)
+	{
+		if (dirtyChunk.Value->BoundaryEpoch == BoundaryEpoch) continue;
+
+		if (!DirtyChunkGroups.Contains(dirtyChunk.Key) && GetMaxGeneratorChange(dirtyChunk.Key->GetBox(VolumeExtent)) > 0.0)
+		{
+			staleGenerations.Add({ dirtyChunk.Key, dirtyChunk.Value->BatchChunkKey });
+		}
+	}
+
+	TakeGeneratorSnapshot();
+
+	for (const TPair<FVoxelChunkNode*, FVoxelChunkNode*>& stale : staleGenerations)
+	{
+		StartChunkGeneration(stale.Key, stale.Value);
+	}
+
+	if (DirtyChunkGroups.Num())
+	{
+		RebatchDirtyChunks(DirtyChunkGroups);
+	}
+
+	UE_LOG(LogTemp, Log, TEXT("[AVoxelVolume::RegenerateForGeneratorChanges] Regenerating %d chunks"), DirtyChunkGroups.Num() + staleGenerations.Num());
+
+	// The editor world doesn't tick the volume, old sections stay until the section update replacing them
+	if (!GetWorld()->IsGameWorld())
+	{
+		UpdateVolume(false, true);
+	}
+}
+
+double AVoxelVolume::GetMaxGeneratorChange(const FBox& InRegion) const
+{
+	const UVoxelProceduralGenerator* pg = ProceduralGeneratorClass.GetDefaultObject();
+	if (!pg || ProceduralGeneratorClass != SnapshotGeneratorClass) return MAX_dbl;
+
+	if (pg->ValueGenerators.Num() != ValueGeneratorSnapshots.Num() || pg->ColumnGenerators.Num() != ColumnGeneratorSnapshots.Num()) return MAX_dbl;
+
+	// The stack adds its generators up, so do their changes
+	double maxChange = 0.0;
+
+	auto AddChange = [&](const auto* InGenerator, const auto* InSnapshot)
+		{
+			if (!InGenerator || !InSnapshot) return InGenerator == InSnapshot;
+			if (UVoxelProceduralGenerator::HashSettings(InGenerator) == UVoxelProceduralGenerator::HashSettings(InSnapshot)) return true;
+
+			double change = 0.0;
+			if (InGenerator->GetClass() != InSnapshot->GetClass() || !InGenerator->GetMaxChange(InSnapshot, InRegion, VolumeExtent, change)) return false;
+
+			maxChange += change;
+			return true;
+		};
+
+	for (int i = 0; i < ValueGeneratorSnapshots.Num(); i++)
+	{
+		if (!AddChange(pg->ValueGenerators[i].Get(), ValueGeneratorSnapshots[i].Get())) return MAX_dbl;
+	}
+
+	for (int i = 0; i < ColumnGeneratorSnapshots.Num(); i++)
+	{
+		if (!AddChange(pg->ColumnGenerators[i].Get(), ColumnGeneratorSnapshots[i].Get())) return MAX_dbl;
+	}
+
+	return maxChange;
+}
+
+void AVoxelVolume::CollectGeneratorChangedLeaves(FVoxelChunkNode* InNode, TMap<FVoxelChunkNode*, TArray<FVoxelChunkNode*>>& OutGroupedDirtyChunks)
+{
+	if (!InNode) return;
+
+	// Same margin as GatherEditOps, normals sample a voxel past the corners
+	const FBox bounds = InNode->GetBox(VolumeExtent).ExpandBy(InNode->GetExtent(VolumeExtent) * 2 / GetChunkResolution(InNode->Depth));
+	const double maxChange = GetMaxGeneratorChange(bounds);
+	if (maxChange <= 0.0) return;
+
+	ReleaseChunkData(ChunkMemory.RemoveRetained(InNode));
+
+	if (!InNode->IsLeaf())
+	{
+		for (FVoxelChunkNode* child : InNode->Children)
+		{
+			CollectGeneratorChangedLeaves(child, OutGroupedDirtyChunks);
+		}
+		return;
+	}
+
+	// Still to be created by a pending batch, restarted in that batch with the other stale generations
+	const FVoxelDirtyChunkData* chunkData = DirtyChunkDataMap.FindRef(InNode);
+	if (chunkData && chunkData->BatchChunkKey != InNode && DirtyChunkBatches.Contains(chunkData->BatchChunkKey)) return;
+
+	// Densities that stay clear of the threshold can't make a surface, and didn't have one before
+	if (InNode->DensityPyramid && !chunkData)
+	{
+		const FFloatInterval& range = InNode->DensityPyramid->GetRoot();
+		if (range.Min - maxChange > ActiveDensityThreshold || range.Max + maxChange < ActiveDensityThreshold) return;
+	}
+
+	OutGroupedDirtyChunks.FindOrAdd(InNode);
+}
+#endif
+
+int AVoxelVolume::GetNumGenerationsInFlight() const
+{
+	int numInFlight = 0;
+
+	auto isInFlight = [this](FVoxelDirtyChunkData* InData)
+		{
+			return InData && !InData->bGenerationQueued && !GenerationPipeline.IsDone(InData);
+		};
+
+	for (const TPair<FVoxelChunkNode*, FVoxelDirtyChunkData*>& dirtyChunk : DirtyChunkDataMap)
+	{
+		numInFlight += isInFlight(dirtyChunk.Value);
+	}
+
+	for (const TPair<FVoxelChunkKey, FPrefetchedChunk>& prefetched : PrefetchedChunks)
+	{
+		numInFlight += isInFlight(prefetched.Value.ChunkData);
+	}
+
+	return numInFlight;
+}
+
+bool AVoxelVolume::IsAtMaxDepth(const FVector& WorldLocation)
+{
+	FVoxelQuery query(this);
+	const FVoxelChunkNode* leaf = query.FindLeaf(GetActorTransform().InverseTransformPosition(WorldLocation));
+
+	return leaf && leaf->Depth == MaxDepth && !DirtyChunkDataMap.Contains(const_cast<FVoxelChunkNode*>(leaf));
+}
+
+double AVoxelVolume::QueryDensity(const FVector& WorldLocation)
+{
+	FVoxelQuery query(this);
+	return query.SampleDensity(GetActorTransform().InverseTransformPosition(WorldLocation));
+}
+
+bool AVoxelVolume::QueryRaycast(const FVector& WorldStart, const FVector& WorldEnd, FVoxelQueryHit& OutHit)
+{
+	return QuerySphereSweep(WorldStart, WorldEnd, 0.0, OutHit);
+}
+
+bool AVoxelVolume::QuerySphereSweep(const FVector& WorldStart, const FVector& WorldEnd, double Radius, FVoxelQueryHit& OutHit)
+{
+	OutHit = FVoxelQueryHit();
+
+	const FTransform& transform = GetActorTransform();
+	const double localRadius = Radius / transform.GetMaximumAxisScale();
+
+	FVector location, normal;
+	double distance;
+
+	FVoxelQuery query(this);
+	if (!query.Sweep(transform.InverseTransformPosition(WorldStart), transform.InverseTransformPosition(WorldEnd), localRadius, location, normal, distance))
+	{
+		return false;
+	}
+
+	OutHit.bHit = true;
+	OutHit.Location = transform.TransformPosition(location);
+	OutHit.Normal = transform.TransformVectorNoScale(normal);
+	OutHit.Distance = (transform.TransformPosition(location + normal * localRadius) - WorldStart).Size();
+	return true;
+}
@@ -8,15 +8,51 @@
 
 #include "RealtimeMeshActor.h"
 
+#include "VoxelChunk/VoxelBatchTracker.h"
+#include "VoxelChunk/VoxelBoundaryCache.h"
+#include "VoxelChunk/VoxelChunkMemory.h"
+#include "VoxelChunk/VoxelChunkNode.h"
+#include "VoxelChunk/VoxelGenerationPipeline.h"
+#include "VoxelChunk/VoxelSectionIdPool.h"
+#include "VoxelChunk/VoxelSectionUpdateBatch.h"
+#include "VoxelEdit/VoxelEditOp.h"
+#include "VoxelEdit/VoxelEditOpGrid.h"
 #include "VoxelProceduralGeneration/Examples/VPG_TestPerlin.h"
+#include "VoxelQuery/VoxelQuery.h"
+#include "VoxelScatter/VoxelScatter.h"
+#include "VoxelUtilities/VoxelMarchingCubes.h"
 
 #include "VoxelVolume.generated.h"
 
+DECLARE_DYNAMIC_MULTICAST_DELEGATE_OneParam(FVoxelBuildProgressSignature, float, Progress);
+
+class AVoxelEditRegion;
 class AVoxelVolume;
 class UBoxComponent;
+class UHierarchicalInstancedStaticMeshComponent;
+class UVoxelSubsystem;
 class UVoxelProceduralGenerator;
-struct FVoxelChunkNode;
 struct FVoxelDirtyChunkData;
+struct FVoxelEditBrickItem;
+struct FVoxelStreamingStats;
+
+UENUM()
+enum EVoxelVertexLayout : uint8
+{
+	// Normals, tangents, texcoords, colors and polygroups
+	VVL_Full,
+	// Normals only, polygroups only when there are several materials
+	VVL_Minimal
+};
+
+UENUM()
+enum EVoxelLodMetric : uint8
+{
+	// Subdivide chunks within LodFactor chunk sizes of the pawn
+	VLM_Distance,
+	// Subdivide chunks whose voxels look bigger than PixelErrorTolerance from the player's camera
+	VLM_ScreenSpaceError
+};
 
 UCLASS()
 class VOXEL_API AVoxelVolume : public ARealtimeMeshActor
@@ -25,7 +61,9 @@ class VOXEL_API AVoxelVolume : public ARealtimeMeshActor
 
 	using FRmcUpdate = TFuture<ERealtimeMeshProxyUpdateStatus>;
 
-	friend class AsyncVoxelGenerateChunk;
+	friend struct FVoxelGenerationPipeline;
+	friend class UVoxelSubsystem;
+	friend struct FVoxelQuery;
 
 	AVoxelVolume();
 
@@ -34,29 +72,183 @@ protected:
 	TMap<FVoxelChunkNode*, TArray<FVoxelChunkNode*>> DirtyChunkBatches;
 	TMap<FVoxelChunkNode*, FVoxelDirtyChunkData*> DirtyChunkDataMap;
 
+	// Chunks generated ahead of the octree for where the pawn is heading, adopted by the node once it's created
+	struct FPrefetchedChunk
+	{
+		FVoxelDirtyChunkData* ChunkData = nullptr;
+		uint32 LastPredictedUpdate = 0;
+	};
+	TMap<FVoxelChunkKey, FPrefetchedChunk> PrefetchedChunks;
+	uint32 PrefetchUpdateCounter = 0;
+
+	// Section changes of the current update, applied together at the end of it
+	FVoxelSectionUpdateBatch PendingSectionUpdates;
+
+	// Bounds of the chunks whose collision the pending section changes add or remove, in volume space
+	TArray<FBox> PendingNavigationBounds;
+
+	// Changed bounds no agent was near yet, by center (unique per node), retried until one comes within NavigationRadius
+	TMap<FVector, FBox> DeferredNavigationBounds;
+	double NextDeferredNavigationTime = 0.0;
+
+	// Scatter instances of each section group by section id, a component per scatter layer. Kept alive as the actor's components
+	TMap<short, TArray<TObjectPtr<UHierarchicalInstancedStaticMeshComponent>>> ScatterComponents;
+
+	// Bytes held per category and chunk data retained after upload
+	FVoxelChunkMemory ChunkMemory;
+
+	// Face samples shared between neighbouring chunks of the same depth
+	FVoxelBoundaryCache BoundaryCache{ &ChunkMemory };
+
+	// Bumped when the generator changes, generations share faces within their epoch only (edits are told apart per face)
+	uint32 BoundaryEpoch = 0;
+
+	// Density, surface and upload preparation of async generations, overlapped across chunks
+	FVoxelGenerationPipeline GenerationPipeline{ this };
+
+	// Completions of the pipeline's generations, so an update only looks at the batches they finish
+	FVoxelBatchTracker BatchTracker;
+
 	FThreadSafeCounter MeshBuildingTracker;
-	short NodeSectionIDTracker = 1;
+	FVoxelSectionIdPool SectionIds;
 
 	FVoxelChunkNode* RootNode = nullptr;
 
+	// Views the octree was last subdivided for
+	TArray<FVoxelLodView> LodViews;
+
+	// World scheduler the volume's generations and updates go through, null when bUseWorldScheduler is off
+	UPROPERTY(Transient)
+	TObjectPtr<UVoxelSubsystem> Scheduler;
+
+	// Measurements for a benchmark, null otherwise
+	FVoxelStreamingStats* StreamingStats = nullptr;
+
+	// Edits the volume gets are appended to it for a benchmark, null otherwise
+	TArray<FVoxelEditOp>* EditRecording = nullptr;
+
+	// Edits applied to the density field, in sequence order and bucketed by location
+	FVoxelEditOpGrid EditOps;
+	uint32 NextEditSequence = 1;
+
+	// Server side, the actor replicating each cell's edits
+	UPROPERTY(Transient)
+	TMap<FIntVector, TObjectPtr<AVoxelEditRegion>> EditRegions;
+
+	// Cells whose snapshot is being baked, and the ops the cells that reached too many bricks wait for before trying again
+	TSet<FIntVector> BakingEditCells;
+	TMap<FIntVector, int32> EditSnapshotRetryOps;
+
+	// Resolved from bCollisionOnly and the net mode when the mesh is (re)generated, read by the async tasks
+	bool bBuildCollisionOnly = false;
+
+#if WITH_EDITORONLY_DATA
+	// Copies of the generator stack the chunks were built from, diffed after an edit to regenerate only what it changed
+	UPROPERTY(Transient)
+	TArray<TObjectPtr<UVoxelProcGen_ValueGenerator>> ValueGeneratorSnapshots;
+
+	UPROPERTY(Transient)
+	TArray<TObjectPtr<UVoxelProcGen_ColumnGenerator>> ColumnGeneratorSnapshots;
+
+	UPROPERTY(Transient)
+	TArray<FBiomeMaterialData> BiomeMaterialSnapshot;
+
+	UPROPERTY(Transient)
+	TSubclassOf<UVoxelProceduralGenerator> SnapshotGeneratorClass;
+#endif
+
+#if WITH_EDITOR
+	FDelegateHandle GeneratorChangedHandle;
+
+	virtual void BeginDestroy() override;
+
+	void TakeGeneratorSnapshot();
+	void OnObjectPropertyChanged(UObject* InObject, FPropertyChangedEvent& InEvent);
+
+	// Regenerates, in place, the leaves whose density the generator edit could have moved across the threshold
+	void RegenerateForGeneratorChanges();
+
+	// Most the generator stack's density can have changed within InRegion since the snapshot, MAX_dbl if unknown
+	double GetMaxGeneratorChange(const FBox& InRegion) const;
+	void CollectGeneratorChangedLeaves(FVoxelChunkNode* InNode, TMap<FVoxelChunkNode*, TArray<FVoxelChunkNode*>>& OutGroupedDirtyChunks);
+#endif
+
 	virtual void BeginPlay() override;
+	virtual void EndPlay(const EEndPlayReason::Type EndPlayReason) override;
 	virtual void OnConstruction(const FTransform& Transform) override;
 	virtual void TickActor(float DeltaTime, ELevelTick TickType, FActorTickFunction& ThisTickFunction) override;
 
 	virtual void OnGenerateMesh_Implementation() override;
 
-	bool GetLodCenter(FVector& OutLocation);
-	void RebatchDirtyChunks(TMap<FVoxelChunkNode*, TArray<FVoxelChunkNode*>>& InDirtyChunkGroups);
+	bool GetLodCenter(FVector& OutLocation, FVector* OutVelocity = nullptr);
+	bool GetLodCenters(TArray<FVector>& OutLocations);
+	bool GetLodView(FVoxelLodView& OutView, FVector* OutVelocity = nullptr);
+	bool ShouldSubdivide(const FVoxelChunkNode& InNode, const TArray<FVoxelLodView>& InLodViews) const;
+	bool IsInAnyView(const FVoxelChunkNode& InNode) const;
+	float GetGenerationImportance(const FVoxelChunkNode& InNode) const;
+	void GatherEditOps(const FVoxelChunkNode& InNode, FVoxelDirtyChunkData* OutChunkData) const;
+	void CollectEditedLeaves(FVoxelChunkNode* InNode, const FBox& InEditBounds, TMap<FVoxelChunkNode*, TArray<FVoxelChunkNode*>>& OutGroupedDirtyChunks);
+	void RegenerateEditedChunks(const FBox& InEditBounds);
+	AVoxelEditRegion* FindOrSpawnEditRegion(const FIntVector& InCell);
+
+	// Server side, bakes the cell's ops into a snapshot off the game thread once it has EditSnapshotThreshold of them
+	void LaunchEditSnapshot(const FIntVector& InCell);
+	void OnEditSnapshotBaked(const TSharedRef<FVoxelEditSnapshot>& InSnapshot, bool bInBaked, TArray<FVoxelEditBrickItem>&& InBricks);
+	void SetupMaterialSlots(URealtimeMeshSimple* InRealtimeMesh);
+	void LaunchGeneration(FVoxelDirtyChunkData* InChunkData, float InImportance, EQueuedWorkPriority InPriority);
+	bool ShouldCreateCollision(const FVoxelChunkNode* InNode) const;
+	void RebatchDirtyChunks(TMap<FVoxelChunkNode*, TArray<FVoxelChunkNode*>>& InDirtyChunkGroups, TArray<FVoxelDirtyChunkData*>* OutDeferredChunks = nullptr);
+	FVoxelDirtyChunkData* StartChunkGeneration(FVoxelChunkNode* InNode, FVoxelChunkNode* InBatchChunkKey, TArray<FVoxelDirtyChunkData*>* OutDeferredChunks = nullptr);
 	bool RechunkToCenter(TMap<FVoxelChunkNode*, TArray<FVoxelChunkNode*>>& OutGroupedDirtyChunks);
 	void RechunkToCenter(
-		const FVector& InLodCenter,
+		const TArray<FVoxelLodView>& InLodViews,
 		TMap<FVoxelChunkNode*, TArray<FVoxelChunkNode*>>& OutGroupedDirtyChunks,
 		FVoxelChunkNode* InMeshNode,
 		FVoxelChunkNode* InParentPreviousLeaf = nullptr
 	);
 
+	void PrefetchPredictedChunks();
+	void CollectPredictedLeaves(
+		const FVoxelLodView& InPredictedView,
+		uint8 InDepth,
+		const FVector& InLocation,
+		const FVoxelChunkNode* InMeshNode,
+		TArray<TPair<FVoxelChunkKey, FVector>>& OutMissingLeaves
+	) const;
+	FVoxelDirtyChunkData* AdoptPrefetchedChunk(FVoxelChunkNode* InNode, FVoxelChunkNode* InBatchChunkKey);
+	void ReleasePrefetchedChunks();
+
+	// Only those whose densities InBounds reaches, in volume space
+	void ReleasePrefetchedChunks(const FBox& InBounds);
+
+	// Cached boundary faces whose samples InBounds reaches, in volume space
+	void RemoveBoundaryFaces(const FBox& InBounds);
+
 	void UpdateVolume(bool bShouldRechunk = true, bool bSynchronous = false);
+	void BuildVolumeParallel();
+	bool IsChunkDataDone(FVoxelChunkNode* InNode, bool bSynchronous);
+	void ReleaseChunkStreams(FVoxelDirtyChunkData* InChunkData);
+	void ReleaseChunkData(FVoxelDirtyChunkData* InChunkData);
+	void ReleaseNodes(FVoxelChunkNode* InNode);
+	void EnforceMemoryBudget();
+
+	// Releases the stalest finished prefetch, else the least recently used retained data, the bytes freed (0 if none)
+	int64 ReleaseLeastRecentlyUsed();
+	void ReleaseAllChunkData();
+	void FlushSectionUpdates(URealtimeMeshSimple* InRealtimeMesh);
+	void AddNavigationBounds(const FVoxelChunkNode* InNode);
+	bool ShouldScatter(const FVoxelChunkNode* InNode) const;
+	void UpdateSectionScatter(short InSectionID, const TArray<FVoxelScatterPoint>& InPoints);
+	void RemoveSectionScatter(short InSectionID);
+	void MarkNavigationDirty(const TArray<FBox>& InBounds);
+	void RetryDeferredNavigation();
+	void FillChunkDensity(FVoxelDirtyChunkData* OutChunkMeshData, bool bParallelSlabs = false);
+	void GenerateChunk(FVoxelDirtyChunkData* OutChunkMeshData, bool bParallelSlabs = false);
+	void RunGenerationStage(FVoxelDirtyChunkData* OutChunkMeshData, EVoxelGenerationStage InStage, bool bParallelSlabs = false);
+	void PrepareChunkUpload(FVoxelDirtyChunkData* OutChunkMeshData);
 	void RegenerateChunk(FVoxelDirtyChunkData* OutChunkMeshData);
+	void RegenerateChunkCollision(FVoxelDirtyChunkData* OutChunkMeshData);
+	VoxelMarchingCubes::FChunkParams MakeMarchingCubesParams(FVoxelDirtyChunkData* InChunkData);
 	bool CancelNodeSection(FVoxelChunkNode* InNode, bool bDeleteIfNotCanceled = false);
 
 public:
@@ -69,9 +261,40 @@ public:
 	UPROPERTY(BlueprintReadWrite, EditAnywhere, Category = "Voxel")
 	TSubclassOf<UVoxelProceduralGenerator> ProceduralGeneratorClass = UVPG_TestPerlin::StaticClass();
 
+	// Let the world's voxel subsystem schedule this volume's generations and updates together with the other volumes
+	UPROPERTY(BlueprintReadWrite, EditAnywhere, Category = "Voxel|Scheduling")
+	bool bUseWorldScheduler = true;
+
+	// Weight of this volume's chunks against other volumes' in the world scheduler
+	UPROPERTY(BlueprintReadWrite, EditAnywhere, Category = "Voxel|Scheduling", Meta = (ClampMin = "0"))
+	float SchedulingImportance = 1.f;
+
+	// Generate the first chunks all at once on every core when the mesh is (re)generated, instead of one by one
+	UPROPERTY(BlueprintReadWrite, EditAnywhere, Category = "Voxel")
+	bool bParallelInitialBuild = true;
+
+	// Progress (0 to 1) of the initial build, broadcast between waves of chunks
+	UPROPERTY(BlueprintAssignable, Category = "Voxel")
+	FVoxelBuildProgressSignature OnBuildProgress;
+
 	// Number of meshes that should be allow to async build at any given time
 	UPROPERTY(BlueprintReadWrite, EditAnywhere, Category = "Voxel")
 	int MeshBuildingLimit = 32;
+
+	// Workers per generation stage, chunks go through density, surface and upload preparation one after the other
+	UPROPERTY(BlueprintReadWrite, EditAnywhere, Category = "Voxel|Pipeline", Meta = (ClampMin = "1"))
+	int DensityWorkers = 4;
+
+	UPROPERTY(BlueprintReadWrite, EditAnywhere, Category = "Voxel|Pipeline", Meta = (ClampMin = "1"))
+	int SurfaceWorkers = 3;
+
+	UPROPERTY(BlueprintReadWrite, EditAnywhere, Category = "Voxel|Pipeline", Meta = (ClampMin = "1"))
+	int UploadPrepWorkers = 1;
+
+	// Chunks waiting for each stage, a stage stops taking chunks while the next one's queue is full. Started chunks past
+	// the density stage's capacity wait in its backlog
+	UPROPERTY(BlueprintReadWrite, EditAnywhere, Category = "Voxel|Pipeline", Meta = (ClampMin = "1"))
+	int PipelineQueueCapacity = 8;
     
 	// Total diameter of the volume's bounds
 	UPROPERTY(BlueprintReadWrite, EditAnywhere, Category = "Voxel", Meta = (ClampMin = "1"))
@@ -80,6 +303,16 @@ public:
 	// Voxels per chunk
 	UPROPERTY(BlueprintReadWrite, EditAnywhere, Category = "Voxel", Meta = (ClampMin = "1"))
 	int ChunkResolution = 64;
+
+	// Voxels per chunk for each depth from the root (e.g. 16, 32, 64), depths past the end use ChunkResolution
+	UPROPERTY(BlueprintReadWrite, EditAnywhere, Category = "Voxel")
+	TArray<int> ChunkResolutionPerDepth;
+
+	UFUNCTION(BlueprintCallable, Category = "Voxel")
+	int GetChunkResolution(uint8 Depth) const
+	{
+		return ChunkResolutionPerDepth.IsValidIndex(Depth) ? FMath::Max(ChunkResolutionPerDepth[Depth], 1) : ChunkResolution;
+	};
 	
 	// Number of subdivisions the main chunk will get to provide more detail (should be near log2(ChunkResolution))
 	UPROPERTY(BlueprintReadWrite, EditAnywhere, Category = "Voxel")
@@ -88,6 +321,18 @@ public:
 	// Factor for chunk render distance
 	UPROPERTY(BlueprintReadWrite, EditAnywhere, Category = "Voxel")
 	float LodFactor = 1.f;
+
+	// How chunks are chosen for subdivision, falls back to distance without a player camera (and for collision only builds)
+	UPROPERTY(BlueprintReadWrite, EditAnywhere, Category = "Voxel")
+	TEnumAsByte<EVoxelLodMetric> LodMetric = VLM_Distance;
+
+	// Size on screen, in pixels, a voxel may have before its chunk is subdivided
+	UPROPERTY(BlueprintReadWrite, EditAnywhere, Category = "Voxel", Meta = (ClampMin = "0.1"))
+	float PixelErrorTolerance = 4.f;
+
+	// Multiplies the screen error of chunks outside the view, lower keeps them coarser and generates them later
+	UPROPERTY(BlueprintReadWrite, EditAnywhere, Category = "Voxel", Meta = (ClampMin = "0", ClampMax = "1"))
+	float OffscreenErrorScale = 0.25f;
     
 	// Threshold that determines the boundary between which corners should be considered fully active (where mesh is created)
 	UPROPERTY(BlueprintReadWrite, EditAnywhere, Category = "Voxel", Meta = (ClampMin = "0", ClampMax = "1"))
@@ -104,4 +349,139 @@ public:
 	// Number of materials to use
 	UPROPERTY(BlueprintReadWrite, EditAnywhere, Category = "Voxel", Meta = (ClampMin = "1"))
 	uint8 NumMaterials = 1;
+
+	// Seconds ahead along the pawn's velocity to generate chunks for, cached until the octree needs them (0 to disable)
+	UPROPERTY(BlueprintReadWrite, EditAnywhere, Category = "Voxel|Prefetch", Meta = (ClampMin = "0"))
+	float PrefetchLookahead = 1.f;
+
+	// Number of prefetch generations allowed in flight, they run at low priority behind the chunks needed now
+	UPROPERTY(BlueprintReadWrite, EditAnywhere, Category = "Voxel|Prefetch", Meta = (ClampMin = "0"))
+	int PrefetchLimit = 8;
+
+	// Chunks of the same depth hand their shared face samples to each other instead of both sampling them
+	UPROPERTY(BlueprintReadWrite, EditAnywhere, Category = "Voxel")
+	bool bShareBoundarySamples = true;
+
+	// Newly subdivided chunks are first meshed from every ProgressiveStep-th corner and shown, then refined in place
+	// at full resolution, sampling only the corners the preview skipped
+	UPROPERTY(BlueprintReadWrite, EditAnywhere, Category = "Voxel|Progressive")
+	bool bProgressiveRefinement = false;
+
+	// Corners between two cells of the preview mesh, must divide the chunk resolution
+	UPROPERTY(BlueprintReadWrite, EditAnywhere, Category = "Voxel|Progressive", Meta = (ClampMin = "2", ClampMax = "4", EditCondition = "bProgressiveRefinement"))
+	int ProgressiveStep = 2;
+
+	// Meshes placed on the surface of the most detailed chunks, points are made by the mesher and follow their chunk's section
+	UPROPERTY(BlueprintReadWrite, EditAnywhere, Category = "Voxel|Scatter")
+	TArray<FVoxelScatterLayer> ScatterLayers;
+
+	// Average distance between scatter points, before the layers filter them
+	UPROPERTY(BlueprintReadWrite, EditAnywhere, Category = "Voxel|Scatter", Meta = (ClampMin = "1"))
+	float ScatterSpacing = 300.f;
+
+	// Chunk depth, from most detailed, to scatter on
+	UPROPERTY(BlueprintReadWrite, EditAnywhere, Category = "Voxel|Scatter")
+	uint8 ScatterInverseDepth = 2;
+
+	// Chunks whose collision changes mark their own bounds dirty in the navigation system, so only their navmesh tiles
+	// are rebuilt. Needs runtime navmesh generation
+	UPROPERTY(BlueprintReadWrite, EditAnywhere, Category = "Voxel|Navigation")
+	bool bUpdateNavigation = false;
+
+	// Distance from any pawn within which changed chunks are rebuilt in the navmesh (0 for everywhere)
+	UPROPERTY(BlueprintReadWrite, EditAnywhere, Category = "Voxel|Navigation", Meta = (ClampMin = "0", EditCondition = "bUpdateNavigation"))
+	float NavigationRadius = 10000.f;
+
+	// Keep corner densities of uploaded chunks for later use, evicted least recently used first when over budget
+	UPROPERTY(BlueprintReadWrite, EditAnywhere, Category = "Voxel|Memory")
+	bool bRetainDensityValues = false;
+
+	// Memory the volume's retained and finished prefetched chunk data should stay under, the rest (nodes, generations
+	// in flight, displayed chunks' pyramids) can't be released (0 for no limit)
+	UPROPERTY(BlueprintReadWrite, EditAnywhere, Category = "Voxel|Memory", Meta = (ClampMin = "0"))
+	int MemoryBudgetMB = 512;
+
+	// Bytes MemoryBudgetMB applies to, what ReleaseLeastRecentlyUsed can free
+	UFUNCTION(BlueprintCallable, Category = "Voxel|Memory")
+	int64 GetEvictableMemoryBytes() const;
+
+	UFUNCTION(BlueprintCallable, Category = "Voxel|Memory")
+	int64 GetChunkMemoryBytes(EVoxelMemoryCategory InCategory) const { return ChunkMemory.Get(InCategory); };
+
+	UFUNCTION(BlueprintCallable, Category = "Voxel|Memory")
+	int64 GetChunkMemoryTotalBytes() const { return ChunkMemory.GetTotal(); };
+
+	// Server only, clients edit through a UVoxelEditComponent they own. Replicated through the edit region of its cell
+	UFUNCTION(BlueprintCallable, BlueprintAuthorityOnly, Category = "Voxel|Edit")
+	void ApplyEdit(EVoxelEditShape Shape, EVoxelEditOperation Operation, const FVector& WorldLocation, float Radius);
+
+	// Applies edits to the density field and regenerates the chunks they touch
+	void AddEditOps(const TArray<FVoxelEditOp>& InOps);
+
+	// Replaces the ops of its cell before it. Clients regenerate what it changed, they may not have had all of those ops
+	void AddEditSnapshot(const TSharedRef<const FVoxelEditSnapshot>& InSnapshot);
+
+	// Ops a cell collects before the server collapses them into a snapshot. Keeps a region's replicated ops, with its
+	// neighbours' ops still reaching into it, under the fast array's 2048 changes per update
+	UPROPERTY(BlueprintReadWrite, EditAnywhere, Category = "Voxel|Edit", Meta = (ClampMin = "8", ClampMax = "64"))
+	int EditSnapshotThreshold = 64;
+
+	// Each cell's edits replicate through their own AVoxelEditRegion actor, relevant to the clients viewing from within
+	// this distance of the cell (0 for every client). Further chunks show the unedited terrain until then, and ops reaching
+	// into a cell from a neighbour come with the neighbour's region
+	UPROPERTY(BlueprintReadWrite, EditAnywhere, Category = "Voxel|Edit", Meta = (ClampMin = "0"))
+	float EditRelevancyDistance = 0.f;
+
+	// Largest brush ApplyEdit accepts, bigger radii are clamped. Clients sending more are disconnected
+	UPROPERTY(BlueprintReadWrite, EditAnywhere, Category = "Voxel|Edit", Meta = (ClampMin = "1"))
+	float MaxEditRadius = 1000.f;
+
+	// World space box edits must be centred in (up to their radius outside it) to affect the volume
+	FBox GetEditableBounds() const;
+
+	// Edits not collapsed into snapshots yet
+	UFUNCTION(BlueprintCallable, Category = "Voxel|Edit")
+	int GetNumEditOps() const { return EditOps.Num(); };
+
+	UFUNCTION(BlueprintCallable, Category = "Voxel|Edit")
+	int GetNumEditSnapshots() const { return EditOps.NumSnapshots(); };
+
+	// Edits not collapsed into snapshots yet in sequence order, locations in the volume's space
+	const TArray<FVoxelEditOp>& GetEditOps() const { return EditOps.GetOps(); };
+
+	// Density at a world location, from retained densities when available, else the generator
+	UFUNCTION(BlueprintCallable, Category = "Voxel|Query")
+	double QueryDensity(const FVector& WorldLocation);
+
+	// First surface hit along a segment, works at any distance and without collision
+	UFUNCTION(BlueprintCallable, Category = "Voxel|Query")
+	bool QueryRaycast(const FVector& WorldStart, const FVector& WorldEnd, FVoxelQueryHit& OutHit);
+
+	// First surface touched by a sphere swept along a segment
+	UFUNCTION(BlueprintCallable, Category = "Voxel|Query")
+	bool QuerySphereSweep(const FVector& WorldStart, const FVector& WorldEnd, double Radius, FVoxelQueryHit& OutHit);
+
+	// Generations started and not done yet, prefetches included
+	int GetNumGenerationsInFlight() const;
+
+	// Whether the chunk shown at a world location is at MaxDepth, and not waiting on its generation
+	bool IsAtMaxDepth(const FVector& WorldLocation);
+
+	// Streaming timings are added to InStats until it's set back to null
+	void SetStreamingStats(FVoxelStreamingStats* InStats) { StreamingStats = InStats; };
+
+	// Edits are appended to InOps as the volume gets them, until it's set back to null
+	void SetEditRecording(TArray<FVoxelEditOp>* InOps) { EditRecording = InOps; };
+
+	// Vertex streams written per chunk, minimal skips the streams that are only filled with constants
+	UPROPERTY(BlueprintReadWrite, EditAnywhere, Category = "Voxel")
+	TEnumAsByte<EVoxelVertexLayout> VertexLayout = VVL_Full;
+
+	// Snap vertices to a 16-bit lattice per chunk, computed from the chunk's corner so positions don't lose precision far from the center
+	UPROPERTY(BlueprintReadWrite, EditAnywhere, Category = "Voxel")
+	bool bQuantizePositions = false;
+
+	// Only build collision around each player, without render attributes or visible sections (always on for dedicated servers)
+	UPROPERTY(BlueprintReadWrite, EditAnywhere, Category = "Voxel")
+	bool bCollisionOnly = false;
 };
\ No newline at end of file